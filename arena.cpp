@@ -0,0 +1,69 @@
+#include <arena.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+thread_local Arena* Arena::current_ = nullptr;
+
+Arena::Arena(size_t chunk_size) : chunk_size_{chunk_size} {
+}
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+    size_t padding = -reinterpret_cast<uintptr_t>(position_) & (alignment - 1);
+    if (padding + size > left_) {
+        // oversized requests get a chunk of their own, so the current one is not wasted
+        size_t chunk_size = std::max(chunk_size_, size + alignment);
+        chunks_.emplace_back(new std::byte[chunk_size]);
+        if (chunk_size == chunk_size_ || !position_) {
+            position_ = chunks_.back().get();
+            left_ = chunk_size;
+        } else {
+            std::byte* chunk = chunks_.back().get();
+            padding = -reinterpret_cast<uintptr_t>(chunk) & (alignment - 1);
+            bytes_allocated_ += size;
+            return chunk + padding;
+        }
+        padding = -reinterpret_cast<uintptr_t>(position_) & (alignment - 1);
+    }
+    void* result = position_ + padding;
+    position_ += padding + size;
+    left_ -= padding + size;
+    bytes_allocated_ += size;
+    return result;
+}
+
+Slab::Handle Slab::Create(size_t count) {
+    Arena* arena = Arena::Current();
+    if (!arena) {
+        return Handle(new Slab(count, nullptr));
+    }
+    return Handle(new (arena->Allocate(sizeof(Slab), alignof(Slab))) Slab(count, arena));
+}
+
+void* Slab::Allocate(size_t size, size_t alignment) {
+    if (!buffer_) {
+        // the first request tells the size of all of them
+        stride_ = (size + alignment - 1) & ~(alignment - 1);
+        alignment_ = alignment;
+        buffer_ = static_cast<std::byte*>(
+            arena_ ? arena_->Allocate(count_ * stride_, alignment)
+                   : ::operator new(count_ * stride_, std::align_val_t(alignment)));
+    }
+    return buffer_ + stride_ * used_++;
+}
+
+void Slab::RemoveReferences(size_t count) {
+    if (references_.fetch_sub(count, std::memory_order_acq_rel) != count) {
+        return;
+    }
+    // arena memory is given back with the arena
+    if (arena_) {
+        this->~Slab();
+        return;
+    }
+    if (buffer_) {
+        ::operator delete(buffer_, std::align_val_t(alignment_));
+    }
+    delete this;
+}
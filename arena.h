@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "runtime_stats.h"
+
+const size_t kDefaultArenaChunkSize = 64 * 1024;
+
+// Bump-pointer allocator: memory is handed out from big chunks and is only given back to the
+// system all at once, when the arena is destroyed.
+class Arena {
+public:
+    explicit Arena(size_t chunk_size = kDefaultArenaChunkSize);
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* Allocate(size_t size, size_t alignment);
+
+    size_t GetBytesAllocated() const {
+        return bytes_allocated_;
+    }
+    size_t GetChunkCount() const {
+        return chunks_.size();
+    }
+
+    // Arena used by New on the calling thread, nullptr if objects go to the regular heap.
+    static Arena* Current() {
+        return current_;
+    }
+
+private:
+    friend class ArenaScope;
+
+    size_t chunk_size_;
+    std::vector<std::unique_ptr<std::byte[]>> chunks_;
+    std::byte* position_ = nullptr;
+    size_t left_ = 0;
+    size_t bytes_allocated_ = 0;
+
+    static thread_local Arena* current_;
+};
+
+// Makes an arena current for the lifetime of the scope.
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena* arena) : previous_{Arena::current_} {
+        Arena::current_ = arena;
+    }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+    ~ArenaScope() {
+        Arena::current_ = previous_;
+    }
+
+private:
+    Arena* previous_;
+};
+
+template <class T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena* arena) : arena_{arena} {
+    }
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_{other.GetArena()} {
+    }
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T*, size_t) {
+    }
+
+    Arena* GetArena() const {
+        return arena_;
+    }
+
+    template <class U>
+    bool operator==(const ArenaAllocator<U>& other) const {
+        return arena_ == other.GetArena();
+    }
+
+private:
+    Arena* arena_;
+};
+
+// Room for a fixed number of allocations of one size, handed out back to back, so objects which
+// are allocated one after another are laid out in that order. The memory comes from the current
+// arena if there is one; otherwise it goes back to the system once the handle returned by Create
+// is gone and every allocation has been given back.
+class Slab {
+    struct Release {
+        void operator()(Slab* slab) const {
+            // slots which were never handed out won't be given back either
+            slab->RemoveReferences(1 + slab->count_ - slab->used_);
+        }
+    };
+
+public:
+    using Handle = std::unique_ptr<Slab, Release>;
+
+    static Handle Create(size_t count);
+    Slab(const Slab&) = delete;
+    Slab& operator=(const Slab&) = delete;
+
+    // Every request must be for the same size, and there must be no more than count of them.
+    void* Allocate(size_t size, size_t alignment);
+    void Deallocate() {
+        RemoveReferences(1);
+    }
+
+private:
+    Slab(size_t count, Arena* arena) : count_{count}, arena_{arena}, references_{count + 1} {
+    }
+    void RemoveReferences(size_t count);
+
+    size_t count_;
+    Arena* arena_;
+    // one for each slot and one for the handle, so handing out a slot costs no atomic operation
+    std::atomic<size_t> references_;
+    size_t used_ = 0;
+    size_t stride_ = 0;
+    size_t alignment_ = 0;
+    std::byte* buffer_ = nullptr;
+};
+
+template <class T>
+class SlabAllocator {
+public:
+    using value_type = T;
+
+    explicit SlabAllocator(Slab* slab) : slab_{slab} {
+    }
+    template <class U>
+    SlabAllocator(const SlabAllocator<U>& other) : slab_{other.GetSlab()} {
+    }
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(slab_->Allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T*, size_t) {
+        slab_->Deallocate();
+    }
+
+    Slab* GetSlab() const {
+        return slab_;
+    }
+
+    template <class U>
+    bool operator==(const SlabAllocator<U>& other) const {
+        return slab_ == other.GetSlab();
+    }
+
+private:
+    Slab* slab_;
+};
+
+// Allocates an object together with its control block in the current arena, if there is one.
+template <class T, class... Args>
+std::shared_ptr<T> New(Args&&... args) {
+    if constexpr (requires { T::kType; }) {
+        CountAllocation(T::kType, sizeof(T));
+    }
+    if (Arena* arena = Arena::Current()) {
+        return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+    }
+    return std::make_shared<T>(std::forward<Args>(args)...);
+}
@@ -0,0 +1,383 @@
+#include "ast_image.h"
+
+#include <bit>
+#include <cstring>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+#include "error.h"
+#include "parser.h"
+#include "tokenizer.h"
+
+static_assert(std::endian::native == std::endian::little, "images are read in place");
+
+namespace {
+
+// The low bits of a node word, the rest of it is the payload. A node which needs more than its
+// payload takes what follows from the words, the links or the digits, in the order of the nodes.
+enum class NodeKind : uint8_t {
+    SMALL_FIXNUM,  // the payload is the value, signed
+    FIXNUM,        // the value is the next word
+    BIGNUM,        // the decimal text of the value, the next payload bytes of the digits
+    SYMBOL,        // the payload is the index of the symbol
+    DOT,
+    VECTOR,  // the payload is the count of elements, the next words
+    LIST,    // the payload is the count of elements, then the tail; their links are the next ones
+};
+const int kKindBits = 3;
+const uint32_t kKindMask = (1 << kKindBits) - 1;
+const uint32_t kMaxPayload = UINT32_MAX >> kKindBits;
+const int64_t kMinSmallFixnum = -(int64_t{1} << (31 - kKindBits));
+const int64_t kMaxSmallFixnum = (int64_t{1} << (31 - kKindBits)) - 1;
+
+// the name of a symbol in the text
+struct SymbolRecord {
+    uint32_t offset;
+    uint32_t size;
+};
+
+// magic, then version, symbol, node, link, word and form counts, text and digits sizes
+const size_t kHeaderSize = sizeof(kAstImageMagic) + 8 * sizeof(uint32_t);
+
+SyntaxError DamagedImage() {
+    return SyntaxError("a compiled script is damaged\n");
+}
+
+// The value at offset, which needn't be aligned.
+template <class T>
+T LoadAt(std::string_view image, size_t offset) {
+    T value;
+    std::memcpy(&value, image.data() + offset, sizeof(T));
+    return value;
+}
+
+template <class T>
+void Append(std::string* output, const T& value) {
+    output->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+void Append(std::string* output, const std::vector<T>& values) {
+    output->append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+// Collects the nodes of the forms given to it. A node is referred to by its index plus one, so
+// that zero can stand for nothing, i.e. the empty list.
+class ImageWriter {
+public:
+    void AddForm(const Object* form) {
+        forms_.push_back(AddTree(form));
+    }
+
+    std::string Finish() const;
+
+private:
+    uint32_t AddTree(const Object* root);
+    uint32_t AddAtom(const Object* object);
+    uint32_t AddList(const std::vector<uint32_t>& elements, uint32_t tail);
+    uint32_t AddNode(NodeKind kind, size_t payload = 0) {
+        if (payload > kMaxPayload || nodes_.size() >= kMaxPayload) {
+            throw RuntimeError("a script is too large to be compiled\n");
+        }
+        nodes_.push_back(static_cast<uint32_t>(payload) << kKindBits |
+                         static_cast<uint32_t>(kind));
+        return static_cast<uint32_t>(nodes_.size());
+    }
+
+    std::vector<int64_t> words_;
+    std::vector<uint32_t> nodes_;
+    std::vector<uint32_t> links_;
+    std::vector<uint32_t> forms_;
+    std::vector<SymbolRecord> symbols_;
+    std::unordered_map<SymbolId, uint32_t> symbol_indices_;
+    std::string text_;
+    std::string digits_;
+};
+
+// Walks the tree with an explicit stack, like Read builds it, so deep nesting is fine. Every
+// chain of cells is written as one list.
+uint32_t ImageWriter::AddTree(const Object* root) {
+    struct PendingList {
+        const Cell* cell;
+        std::vector<uint32_t> elements;
+    };
+    std::vector<PendingList> pending;
+    const Object* object = root;
+    while (true) {
+        if (Is<Cell>(object)) {
+            const Cell* cell = static_cast<const Cell*>(object);
+            pending.push_back({cell, {}});
+            object = cell->ViewFirst();
+            continue;
+        }
+        uint32_t node = AddAtom(object);
+
+        // `node` is written, hand it to the list waiting for it
+        while (true) {
+            if (pending.empty()) {
+                return node;
+            }
+            PendingList& list = pending.back();
+            list.elements.push_back(node);
+            const Object* second = list.cell->ViewSecond();
+            if (Is<Cell>(second)) {
+                list.cell = static_cast<const Cell*>(second);
+                object = list.cell->ViewFirst();
+                break;
+            }
+            node = AddList(list.elements, AddAtom(second));
+            pending.pop_back();
+        }
+    }
+}
+
+uint32_t ImageWriter::AddAtom(const Object* object) {
+    if (!object) {
+        return 0;
+    }
+    switch (object->GetType()) {
+        case ObjectType::NUMBER: {
+            const Number* number = static_cast<const Number*>(object);
+            if (!number->IsFixnum()) {
+                std::string text = number->ToBigInteger().ToString();
+                digits_ += text;
+                return AddNode(NodeKind::BIGNUM, text.size());
+            }
+            int64_t value = number->GetValue();
+            if (value < kMinSmallFixnum || value > kMaxSmallFixnum) {
+                words_.push_back(value);
+                return AddNode(NodeKind::FIXNUM);
+            }
+            // the sign bit of the value ends up in the top bit of the node
+            uint32_t node = AddNode(NodeKind::SMALL_FIXNUM);
+            nodes_.back() |= static_cast<uint32_t>(value) << kKindBits;
+            return node;
+        }
+        case ObjectType::SYMBOL: {
+            SymbolId id = static_cast<const Symbol*>(object)->GetId();
+            auto [it, is_new] = symbol_indices_.try_emplace(id, symbols_.size());
+            if (is_new) {
+                const std::string& name = SymbolName(id);
+                symbols_.push_back({static_cast<uint32_t>(text_.size()),
+                                    static_cast<uint32_t>(name.size())});
+                text_ += name;
+            }
+            return AddNode(NodeKind::SYMBOL, it->second);
+        }
+        case ObjectType::DOT:
+            return AddNode(NodeKind::DOT);
+        case ObjectType::NUMERIC_VECTOR: {
+            std::span<const int64_t> elements =
+                static_cast<const NumericVector*>(object)->GetElements();
+            words_.insert(words_.end(), elements.begin(), elements.end());
+            return AddNode(NodeKind::VECTOR, elements.size());
+        }
+        default:
+            // Read makes nothing else
+            throw RuntimeError("this object can't be written to a compiled script\n");
+    }
+}
+
+uint32_t ImageWriter::AddList(const std::vector<uint32_t>& elements, uint32_t tail) {
+    uint32_t node = static_cast<uint32_t>(nodes_.size()) + 1;
+    for (uint32_t element : elements) {
+        links_.push_back(element ? node - element : 0);
+    }
+    links_.push_back(tail ? node - tail : 0);
+    return AddNode(NodeKind::LIST, elements.size());
+}
+
+std::string ImageWriter::Finish() const {
+    if (text_.size() > UINT32_MAX || digits_.size() > UINT32_MAX) {
+        throw RuntimeError("a script is too large to be compiled\n");
+    }
+    std::string image(kAstImageMagic, sizeof(kAstImageMagic));
+    uint32_t header[] = {kAstImageVersion,
+                         static_cast<uint32_t>(symbols_.size()),
+                         static_cast<uint32_t>(nodes_.size()),
+                         static_cast<uint32_t>(links_.size()),
+                         static_cast<uint32_t>(words_.size()),
+                         static_cast<uint32_t>(forms_.size()),
+                         static_cast<uint32_t>(text_.size()),
+                         static_cast<uint32_t>(digits_.size())};
+    Append(&image, header);
+    // the words first, so they stay aligned in a mapping
+    Append(&image, words_);
+    Append(&image, nodes_);
+    Append(&image, links_);
+    Append(&image, forms_);
+    Append(&image, symbols_);
+    image += text_;
+    image += digits_;
+    return image;
+}
+
+}  // namespace
+
+std::string WriteAstImage(std::string_view text) {
+    ImageWriter writer;
+    for (std::string_view form : FormReader::Split(text)) {
+        Tokenizer tokenizer{form};
+        std::shared_ptr<Object> ast = Read(&tokenizer);
+        if (!tokenizer.IsEnd()) {
+            throw SyntaxError("an expression can't be read in full size\n");
+        }
+        writer.AddForm(ast.get());
+    }
+    return writer.Finish();
+}
+
+AstImage::AstImage(std::string_view image) : image_{image} {
+    if (image.size() < kHeaderSize ||
+        image.substr(0, sizeof(kAstImageMagic)) != std::string_view(kAstImageMagic, 8)) {
+        throw SyntaxError("not a compiled script\n");
+    }
+    uint32_t header[8];
+    std::memcpy(header, image.data() + sizeof(kAstImageMagic), sizeof(header));
+    if (header[0] != kAstImageVersion) {
+        throw SyntaxError("a compiled script of format version " + std::to_string(header[0]) +
+                          ", this build reads version " + std::to_string(kAstImageVersion) +
+                          "\n");
+    }
+    symbol_count_ = header[1];
+    node_count_ = header[2];
+    link_count_ = header[3];
+    word_count_ = header[4];
+    form_count_ = header[5];
+    text_size_ = header[6];
+    digits_size_ = header[7];
+
+    // 64-bit sums of 32-bit counts, they can't overflow
+    uint64_t end = kHeaderSize;
+    auto add_section = [&](size_t* begin, uint64_t size) {
+        *begin = end;
+        end += size;
+    };
+    add_section(&words_, uint64_t{word_count_} * sizeof(int64_t));
+    add_section(&nodes_, uint64_t{node_count_} * sizeof(uint32_t));
+    add_section(&links_, uint64_t{link_count_} * sizeof(uint32_t));
+    add_section(&forms_, uint64_t{form_count_} * sizeof(uint32_t));
+    add_section(&symbols_, uint64_t{symbol_count_} * sizeof(SymbolRecord));
+    add_section(&text_, text_size_);
+    add_section(&digits_, digits_size_);
+    if (end != image.size()) {
+        throw DamagedImage();
+    }
+}
+
+std::vector<std::shared_ptr<Object>> AstImage::Load() const {
+    std::string_view text = image_.substr(text_, text_size_);
+    std::string_view digits = image_.substr(digits_, digits_size_);
+
+    // each name is looked up once, however many nodes refer to it
+    std::vector<SymbolId> symbols(symbol_count_);
+    for (uint32_t i = 0; i < symbol_count_; ++i) {
+        auto symbol = LoadAt<SymbolRecord>(image_, symbols_ + i * sizeof(SymbolRecord));
+        if (symbol.offset > text.size() || symbol.size > text.size() - symbol.offset) {
+            throw DamagedImage();
+        }
+        symbols[i] = Intern(text.substr(symbol.offset, symbol.size));
+    }
+
+    // what the nodes so far have taken of the words, the links and the digits
+    uint32_t word = 0;
+    uint32_t link = 0;
+    size_t digit = 0;
+    auto take_words = [&](uint32_t count) {
+        if (count > word_count_ - word) {
+            throw DamagedImage();
+        }
+        size_t offset = words_ + size_t{word} * sizeof(int64_t);
+        word += count;
+        return offset;
+    };
+
+    // a node is moved out of here by the one node which refers to it
+    std::vector<std::shared_ptr<Object>> nodes(node_count_);
+    auto take = [&](uint32_t node) -> std::shared_ptr<Object> {
+        uint32_t distance = LoadAt<uint32_t>(image_, links_ + size_t{link++} * sizeof(uint32_t));
+        if (!distance) {
+            return nullptr;
+        }
+        if (distance > node) {
+            throw DamagedImage();
+        }
+        return std::move(nodes[node - distance]);
+    };
+    std::vector<std::shared_ptr<Object>> elements;
+    for (uint32_t i = 0; i < node_count_; ++i) {
+        uint32_t node = LoadAt<uint32_t>(image_, nodes_ + size_t{i} * sizeof(uint32_t));
+        uint32_t payload = node >> kKindBits;
+        switch (static_cast<NodeKind>(node & kKindMask)) {
+            case NodeKind::SMALL_FIXNUM:
+                nodes[i] = MakeNumber(static_cast<int32_t>(node) >> kKindBits);
+                break;
+            case NodeKind::FIXNUM:
+                nodes[i] = MakeNumber(LoadAt<int64_t>(image_, take_words(1)));
+                break;
+            case NodeKind::BIGNUM: {
+                if (payload > digits.size() - digit) {
+                    throw DamagedImage();
+                }
+                std::string_view value_digits = digits.substr(digit, payload);
+                digit += payload;
+                bool is_negative = !value_digits.empty() && value_digits.front() == '-';
+                if (is_negative) {
+                    value_digits.remove_prefix(1);
+                }
+                std::optional<BigInteger> value = BigInteger::Parse(value_digits);
+                if (!value) {
+                    throw DamagedImage();
+                }
+                nodes[i] = MakeNumber(is_negative ? -*value : std::move(*value));
+                break;
+            }
+            case NodeKind::SYMBOL:
+                if (payload >= symbol_count_) {
+                    throw DamagedImage();
+                }
+                nodes[i] = New<Symbol>(symbols[payload]);
+                break;
+            case NodeKind::DOT:
+                nodes[i] = New<Dot>();
+                break;
+            case NodeKind::VECTOR: {
+                // checked before allocating, a damaged count may be huge
+                size_t offset = take_words(payload);
+                std::vector<int64_t> words(payload);
+                if (payload) {
+                    std::memcpy(words.data(), image_.data() + offset, payload * sizeof(int64_t));
+                }
+                nodes[i] = New<NumericVector>(std::move(words));
+                break;
+            }
+            case NodeKind::LIST: {
+                // the elements and the tail
+                if (payload >= link_count_ - link) {
+                    throw DamagedImage();
+                }
+                elements.clear();
+                for (uint32_t j = 0; j < payload; ++j) {
+                    elements.push_back(take(i));
+                }
+                std::shared_ptr<Object> tail = take(i);
+                nodes[i] = MakeList(elements, std::move(tail));
+                break;
+            }
+            default:
+                throw DamagedImage();
+        }
+    }
+
+    std::vector<std::shared_ptr<Object>> forms(form_count_);
+    for (uint32_t i = 0; i < form_count_; ++i) {
+        // the index of the node plus one, zero for the empty list
+        uint32_t form = LoadAt<uint32_t>(image_, forms_ + i * sizeof(uint32_t));
+        if (form > node_count_) {
+            throw DamagedImage();
+        }
+        forms[i] = form ? std::move(nodes[form - 1]) : nullptr;
+    }
+    return forms;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "object.h"
+
+// An image holds the top-level forms of a script as Read leaves them, so loading it skips the
+// tokenizer and the reader. After a header come the nodes, a word each, children before their
+// parents; a list is one node referring to its elements and its tail by how many nodes back they
+// are. Symbols are stored once each, by name, so an image doesn't depend on the symbol ids of
+// the process which wrote it. Everything is little-endian.
+const char kAstImageMagic[8] = {'S', 'C', 'M', 'A', 'S', 'T', '\r', '\n'};
+// Images of any other version are refused; bump it whenever the layout changes.
+const uint32_t kAstImageVersion = 1;
+
+// Reads every top-level form of text and writes them as an image. Throws what Read throws for a
+// form which can't be read.
+std::string WriteAstImage(std::string_view text);
+
+// An image in memory, e.g. a mapped file. Only the header is looked at up front; the nodes are
+// checked as they are loaded.
+class AstImage {
+public:
+    // Throws SyntaxError if image is not an image of kAstImageVersion.
+    explicit AstImage(std::string_view image);
+
+    size_t GetFormCount() const {
+        return form_count_;
+    }
+    size_t GetNodeCount() const {
+        return node_count_;
+    }
+
+    // Builds the trees of the forms with New, i.e. in the current arena if there is one, and
+    // lists with MakeList, laid out as Read lays them out. Throws SyntaxError if the image is
+    // damaged.
+    std::vector<std::shared_ptr<Object>> Load() const;
+
+private:
+    std::string_view image_;
+    uint32_t symbol_count_ = 0;
+    uint32_t node_count_ = 0;
+    uint32_t link_count_ = 0;
+    uint32_t word_count_ = 0;
+    uint32_t form_count_ = 0;
+    uint32_t text_size_ = 0;
+    uint32_t digits_size_ = 0;
+    // where the sections start within image_
+    size_t words_ = 0;
+    size_t nodes_ = 0;
+    size_t links_ = 0;
+    size_t forms_ = 0;
+    size_t symbols_ = 0;
+    size_t text_ = 0;
+    size_t digits_ = 0;
+};
@@ -0,0 +1,96 @@
+// Measures what an image saves at startup: building the trees of a large script with the
+// tokenizer and the reader against loading them from its image, and a fresh interpreter running
+// the whole script from its text (RunFile) against running it from the image (RunAstImage).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <arena.h>
+#include <ast_image.h>
+#include <parser.h>
+#include <scheme.h>
+#include <tokenizer.h>
+
+namespace {
+
+const size_t kDefaultFunctions = 2'000;
+const size_t kRepetitions = 5;
+
+// Function definitions and calls, quoted data and literals, the kind of text a script is made of.
+std::string MakeScript(size_t function_count) {
+    std::string script;
+    for (size_t i = 0; i < function_count; ++i) {
+        std::string name = "f" + std::to_string(i);
+        script += "(define (" + name + " n)\n  (if (< n 2) n (+ (" + name + " (- n 1)) " +
+                  std::to_string(i) + ")))\n";
+        script += "(" + name + " 5)\n";
+        script += "(length '(alpha beta (gamma delta) 1 2 3 \"x\" 4 5))\n";
+        script += "(vector-length #(1 2 3 4 5 6 7 8))\n";
+        script += "(+ 123456789012345678901234567890 " + std::to_string(i) + ")\n";
+    }
+    return script;
+}
+
+void WriteFile(const std::string& path, const std::string& contents) {
+    std::ofstream(path, std::ios::binary) << contents;
+}
+
+// The best of kRepetitions runs of step, in microseconds.
+template <class Step>
+double BestMicroseconds(Step&& step) {
+    double best = 0;
+    for (size_t i = 0; i < kRepetitions; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        step();
+        std::chrono::duration<double, std::micro> elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = i == 0 ? elapsed.count() : std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t function_count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultFunctions;
+    std::string script = MakeScript(function_count);
+    std::string image = WriteAstImage(script);
+    std::string base_path = "/tmp/ast_image_bench." + std::to_string(getpid());
+    WriteFile(base_path + ".scm", script);
+    WriteFile(base_path + ".img", image);
+    std::cout << "script " << script.size() << " bytes, image " << image.size() << " bytes, "
+              << AstImage(image).GetNodeCount() << " nodes\n";
+
+    double read_us = BestMicroseconds([&] {
+        Arena arena;
+        ArenaScope arena_scope(&arena);
+        std::vector<std::shared_ptr<Object>> forms;
+        for (std::string_view form : FormReader::Split(script)) {
+            Tokenizer tokenizer{form};
+            forms.push_back(Read(&tokenizer));
+        }
+    });
+    double load_us = BestMicroseconds([&] {
+        Arena arena;
+        ArenaScope arena_scope(&arena);
+        std::vector<std::shared_ptr<Object>> forms = AstImage(image).Load();
+    });
+    std::cout << "trees: read " << read_us << " us, image " << load_us << " us\n";
+
+    double run_file_us = BestMicroseconds([&] { Interpreter().RunFile(base_path + ".scm"); });
+    double run_image_us =
+        BestMicroseconds([&] { Interpreter().RunAstImage(base_path + ".img"); });
+    std::cout << "startup: text " << run_file_us << " us, image " << run_image_us << " us\n";
+
+    unlink((base_path + ".scm").c_str());
+    unlink((base_path + ".img").c_str());
+    return 0;
+}
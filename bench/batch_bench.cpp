@@ -0,0 +1,53 @@
+// Throughput of Interpreter::RunBatch on a bulk of independent expressions for a growing number
+// of worker threads.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <scheme.h>
+
+namespace {
+
+const size_t kDefaultCount = 20'000;
+
+std::vector<std::string> BuildExpressions(size_t count) {
+    std::vector<std::string> expressions;
+    expressions.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string n = std::to_string(i % 1000);
+        expressions.push_back("(let ((x " + n + ") (y 7)) (if (> x y) (sum-to x 0) (max x y)))");
+    }
+    return expressions;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultCount;
+    std::vector<std::string> expressions = BuildExpressions(count);
+
+    Interpreter interpreter;
+    interpreter.Run("(define (sum-to n acc) (if (= n 0) acc (sum-to (- n 1) (+ acc n))))");
+
+    size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    double single_thread = 0;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<BatchResult> results = interpreter.RunBatch(expressions, threads);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        size_t failed = std::count_if(results.begin(), results.end(),
+                                      [](const BatchResult& result) { return result.error; });
+        if (threads == 1) {
+            single_thread = elapsed.count();
+        }
+        std::cout << threads << " threads: " << count / elapsed.count() << " expressions/s, "
+                  << "speedup " << single_thread / elapsed.count() << " (" << failed
+                  << " failed)\n";
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+// Measures exact integer arithmetic: + and * over fixnums, which stay on the overflow-checked
+// int64_t path, the same over values which overflow it and get promoted, and BigInteger
+// multiplication of growing operands, whose time should grow about 3x per doubling rather than
+// the 4x of schoolbook multiplication once Karatsuba takes over.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <bignum.h>
+#include <object.h>
+
+namespace {
+
+const size_t kDefaultIterations = 200'000;
+const size_t kArguments = 64;
+const size_t kMaxDigits = 40'000;
+
+double NsPerCall(SymbolId function, const std::vector<std::shared_ptr<Object>>& arguments,
+                 size_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    size_t sink = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        sink += ApplyBuiltinFunction(function, arguments) != nullptr;
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    if (sink != iterations) {
+        std::cout << "unexpected result\n";
+    }
+    return elapsed.count() / iterations;
+}
+
+std::vector<std::shared_ptr<Object>> MakeArguments(int64_t value) {
+    std::vector<std::shared_ptr<Object>> arguments;
+    for (size_t i = 0; i < kArguments; ++i) {
+        arguments.push_back(MakeNumber(value + static_cast<int64_t>(i)));
+    }
+    return arguments;
+}
+
+BigInteger MakeOperand(size_t digits, char seed) {
+    std::string text(digits, '0');
+    for (size_t i = 0; i < digits; ++i) {
+        text[i] = static_cast<char>('1' + (seed + i * 7) % 9);
+    }
+    return *BigInteger::Parse(text);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultIterations;
+
+    std::vector<std::shared_ptr<Object>> small = MakeArguments(1);
+    std::vector<std::shared_ptr<Object>> large = MakeArguments(1'000'000'000'000'000'000);
+    std::cout << "+ of " << kArguments << " fixnums: " << NsPerCall(PLUS, small, iterations)
+              << " ns\n";
+    std::cout << "+ overflowing int64_t: " << NsPerCall(PLUS, large, iterations) << " ns\n";
+    std::cout << "* of " << kArguments << " fixnums, overflowing: "
+              << NsPerCall(MULTIPLY, small, iterations / 10) << " ns\n";
+
+    double previous = 0;
+    for (size_t digits = 625; digits <= kMaxDigits; digits *= 2) {
+        BigInteger lhs = MakeOperand(digits, 1);
+        BigInteger rhs = MakeOperand(digits, 5);
+        size_t repeats = std::max<size_t>(1, kMaxDigits / digits);
+        auto start = std::chrono::steady_clock::now();
+        size_t sink = 0;
+        for (size_t i = 0; i < repeats; ++i) {
+            sink += (lhs * rhs).IsNegative();
+        }
+        std::chrono::duration<double, std::micro> elapsed =
+            std::chrono::steady_clock::now() - start;
+        double us = elapsed.count() / repeats;
+        std::cout << digits << " digit product: " << us << " us";
+        if (previous > 0) {
+            std::cout << ", " << us / previous << "x the previous size";
+        }
+        std::cout << (sink ? " (negative?)\n" : "\n");
+        previous = us;
+    }
+    return 0;
+}
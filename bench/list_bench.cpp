@@ -0,0 +1,53 @@
+// Measures the builtins over lists of growing length: list construction, which should grow
+// linearly, and length, list?, list-ref and list-tail of the last element, which should stay
+// flat since a list built at once is a single run of cells.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <object.h>
+
+namespace {
+
+const size_t kDefaultIterations = 2'000;
+const size_t kMaxElements = 100'000;
+
+double NsPerCall(SymbolId function, const std::vector<std::shared_ptr<Object>>& arguments,
+                 size_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    size_t sink = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        sink += ApplyBuiltinFunction(function, arguments) != nullptr;
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    if (sink != iterations) {
+        std::cout << "unexpected result\n";
+    }
+    return elapsed.count() / iterations;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultIterations;
+
+    for (size_t elements = 100; elements <= kMaxElements; elements *= 10) {
+        std::vector<std::shared_ptr<Object>> numbers;
+        for (size_t i = 0; i < elements; ++i) {
+            numbers.push_back(MakeNumber(static_cast<int64_t>(i)));
+        }
+        std::vector<std::shared_ptr<Object>> list = {ApplyBuiltinFunction(LIST, numbers)};
+        std::vector<std::shared_ptr<Object>> last = {list[0], numbers.back()};
+        size_t construction_iterations = std::max<size_t>(1, iterations * 100 / elements);
+        std::cout << elements << " elements: list " << NsPerCall(LIST, numbers,
+                                                                 construction_iterations)
+                  << " ns, length " << NsPerCall(LENGTH, list, iterations) << " ns, list? "
+                  << NsPerCall(IS_LIST, list, iterations) << " ns, list-ref "
+                  << NsPerCall(LIST_REF, last, iterations) << " ns, list-tail "
+                  << NsPerCall(LIST_TAIL, last, iterations) << " ns\n";
+    }
+    return 0;
+}
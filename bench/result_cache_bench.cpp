@@ -0,0 +1,76 @@
+// Runs a stream of expressions in which a few hot ones repeat verbatim, with and without the
+// result cache, and reports the throughput and the cache counters.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <scheme.h>
+
+namespace {
+
+const size_t kDefaultCount = 200'000;
+const size_t kHotExpressions = 16;
+const size_t kColdExpressions = 20'000;
+
+std::string MakeExpression(size_t seed) {
+    std::string n = std::to_string(seed);
+    return "(list (+ (* " + n + " 3) (max 1 " + n + " 7) (car (cdr '(1 " + n +
+           " 3))) (abs (- 10 " + n + "))) (cons " + n + " (list 2 3)))";
+}
+
+// Nine of ten expressions are one of the hot ones.
+std::vector<std::string> BuildStream(size_t count) {
+    std::mt19937 random(1);
+    std::vector<std::string> stream;
+    stream.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t seed = random() % 10 ? random() % kHotExpressions
+                                    : kHotExpressions + random() % kColdExpressions;
+        stream.push_back(MakeExpression(seed));
+    }
+    return stream;
+}
+
+double RunStream(Interpreter* interpreter, const std::vector<std::string>& stream) {
+    auto start = std::chrono::steady_clock::now();
+    size_t failed = 0;
+    for (const std::string& expression : stream) {
+        try {
+            interpreter->Run(expression);
+        } catch (const std::exception&) {
+            ++failed;
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (failed) {
+        std::cout << failed << " expressions failed\n";
+    }
+    return stream.size() / elapsed.count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultCount;
+    std::vector<std::string> stream = BuildStream(count);
+
+    Interpreter uncached;
+    double uncached_rate = RunStream(&uncached, stream);
+    std::cout << "no cache: " << uncached_rate << " expressions/s\n";
+
+    for (size_t max_entries : {8, 64, 4096}) {
+        Interpreter cached;
+        cached.SetResultCacheLimits({max_entries, 1 << 20});
+        double rate = RunStream(&cached, stream);
+        ResultCacheStats stats = cached.GetResultCacheStats();
+        std::cout << max_entries << " entries: " << rate << " expressions/s, speedup "
+                  << rate / uncached_rate << ", " << stats.hits << " hits, " << stats.misses
+                  << " misses, " << stats.evictions << " evictions, " << stats.bytes
+                  << " bytes\n";
+    }
+    return 0;
+}
@@ -0,0 +1,221 @@
+// Benchmarks every phase of the interpreter on generated workloads: tokenize, read (tokenize and
+// parse), compile, execute, calc (the AST walker), print, whole Interpreter::Run calls and
+// Interpreter::Execute of an expression prepared once.
+// The separate phases allocate nodes on the heap, run uses the interpreter's default arena mode.
+// Reports ns/op and heap allocations/op per phase and the peak RSS of the process. With
+// --json FILE the same numbers are written as JSON for tracking regressions; --quick runs a tenth
+// of the iterations.
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <scheme.h>
+
+namespace {
+
+std::atomic<size_t> allocation_count = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+std::shared_ptr<Object> Calc(const std::shared_ptr<Object>& root);
+
+namespace {
+
+struct Workload {
+    std::string name;
+    std::string expression;
+    size_t iterations;
+};
+
+struct Measurement {
+    std::string workload;
+    std::string phase;
+    size_t iterations;
+    double ns_per_op;
+    double allocations_per_op;
+};
+
+std::string Numbers(std::string_view head, size_t count) {
+    std::string expression(head);
+    for (size_t i = 1; i <= count; ++i) {
+        expression += " " + std::to_string(i % 1000);
+    }
+    return expression + ")";
+}
+
+std::vector<Workload> MakeWorkloads(size_t scale) {
+    std::vector<Workload> workloads;
+    workloads.push_back({"flat_list", Numbers("'(", 100'000), 20});
+    workloads.push_back({"wide_fold", Numbers("(+", 100'000), 20});
+
+    const size_t depth = 10'000;
+    std::string nesting = "'" + std::string(depth, '(') + "leaf" + std::string(depth, ')');
+    workloads.push_back({"deep_nesting", nesting, 20});
+
+    std::string quoted = "'(";
+    for (size_t i = 0; i < 10'000; ++i) {
+        quoted += " (key" + std::to_string(i % 100) + " . " + std::to_string(i) + ")";
+    }
+    workloads.push_back({"quoted_data", quoted + ")", 50});
+
+    workloads.push_back({"small_expression", "(max (+ 1 2) (* 3 4) (abs -20))", 200'000});
+
+    for (Workload& workload : workloads) {
+        workload.iterations = std::max<size_t>(1, workload.iterations / scale);
+    }
+    return workloads;
+}
+
+std::shared_ptr<Object> Parse(const std::string& expression) {
+    Tokenizer tokenizer{std::string_view(expression)};
+    return Read(&tokenizer);
+}
+
+// Times `iterations` calls of `operation`, `prepare` runs before each of them untimed.
+Measurement Measure(const Workload& workload, const std::string& phase,
+                    const std::function<void(size_t)>& operation,
+                    const std::function<void(size_t)>& prepare = nullptr) {
+    std::chrono::duration<double, std::nano> elapsed{0};
+    size_t allocations = 0;
+    for (size_t i = 0; i < workload.iterations; ++i) {
+        if (prepare) {
+            prepare(i);
+        }
+        size_t allocations_before = allocation_count.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        operation(i);
+        elapsed += std::chrono::steady_clock::now() - start;
+        allocations += allocation_count.load(std::memory_order_relaxed) - allocations_before;
+    }
+    double iterations = static_cast<double>(workload.iterations);
+    return {workload.name, phase, workload.iterations, elapsed.count() / iterations,
+            allocations / iterations};
+}
+
+std::vector<Measurement> RunWorkload(const Workload& workload) {
+    std::vector<Measurement> measurements;
+    const std::string& expression = workload.expression;
+
+    measurements.push_back(Measure(workload, "tokenize", [&](size_t) {
+        Tokenizer tokenizer{std::string_view(expression)};
+        while (!tokenizer.IsEnd()) {
+            tokenizer.Next();
+        }
+    }));
+
+    std::shared_ptr<Object> ast;
+    measurements.push_back(Measure(
+        workload, "read", [&](size_t) { ast = Parse(expression); },
+        [&](size_t) { ast = nullptr; }));
+
+    Program program;
+    measurements.push_back(Measure(workload, "compile", [&](size_t) { program = Compile(ast); }));
+
+    GlobalEnvironment globals;
+    std::shared_ptr<Object> result;
+    measurements.push_back(Measure(
+        workload, "execute", [&](size_t) { result = Execute(program, &globals); },
+        [&](size_t) { result = nullptr; }));
+
+    std::string printed;
+    measurements.push_back(Measure(workload, "print", [&](size_t) {
+        printed = result ? result->ToString() : MakeNullptr()->ToString();
+    }));
+
+    measurements.push_back(Measure(
+        workload, "calc", [&](size_t) { result = Calc(ast); }, [&](size_t) { result = nullptr; }));
+
+    Interpreter interpreter;
+    measurements.push_back(
+        Measure(workload, "run", [&](size_t) { printed = interpreter.Run(expression); }));
+
+    std::shared_ptr<const PreparedExpression> prepared = interpreter.Prepare(expression);
+    measurements.push_back(Measure(workload, "prepared",
+                                   [&](size_t) { printed = interpreter.Execute(*prepared); }));
+    return measurements;
+}
+
+size_t PeakRssKilobytes() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+void WriteJson(const std::string& path, const std::vector<Measurement>& measurements) {
+    std::ofstream out(path);
+    out << std::fixed << std::setprecision(1);
+    out << "{\n  \"peak_rss_kb\": " << PeakRssKilobytes() << ",\n  \"measurements\": [\n";
+    for (size_t i = 0; i < measurements.size(); ++i) {
+        const Measurement& measurement = measurements[i];
+        out << "    {\"workload\": \"" << measurement.workload << "\", \"phase\": \""
+            << measurement.phase << "\", \"iterations\": " << measurement.iterations
+            << ", \"ns_per_op\": " << measurement.ns_per_op
+            << ", \"allocations_per_op\": " << measurement.allocations_per_op << "}"
+            << (i + 1 < measurements.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string json_path;
+    size_t scale = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--quick") == 0) {
+            scale = 10;
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--json FILE] [--quick]\n";
+            return 1;
+        }
+    }
+
+    std::vector<Measurement> measurements;
+    std::cout << std::left << std::setw(18) << "workload" << std::setw(10) << "phase"
+              << std::right << std::setw(16) << "ns/op" << std::setw(16) << "allocs/op" << "\n";
+    for (const Workload& workload : MakeWorkloads(scale)) {
+        for (const Measurement& measurement : RunWorkload(workload)) {
+            std::cout << std::left << std::setw(18) << measurement.workload << std::setw(10)
+                      << measurement.phase << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(16) << measurement.ns_per_op << std::setw(16)
+                      << measurement.allocations_per_op << "\n";
+            measurements.push_back(measurement);
+        }
+    }
+    std::cout << "peak RSS: " << PeakRssKilobytes() << " KB\n";
+
+    if (!json_path.empty()) {
+        WriteJson(json_path, measurements);
+    }
+    return 0;
+}
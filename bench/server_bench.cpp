@@ -0,0 +1,86 @@
+// Measures round trips to a Server on a Unix domain socket: small expressions sent one after
+// another by each client, the latencies seen by the clients against a Run of the same expression
+// in process, which is what a round trip adds to.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <scheme.h>
+#include <server.h>
+
+namespace {
+
+const size_t kDefaultIterations = 20'000;
+const char* const kExpression = "(+ (* 2 3) (- 10 4) (max 1 2 3) (car (cdr (list 1 2 3))))";
+
+double Percentile(std::vector<double> values, size_t percent) {
+    auto nth = values.begin() + (values.size() - 1) * percent / 100;
+    std::nth_element(values.begin(), nth, values.end());
+    return *nth;
+}
+
+// Latencies in microseconds of `iterations` round trips from each of `client_count` clients.
+std::vector<double> Measure(const std::string& socket_path, size_t client_count,
+                            size_t iterations) {
+    std::vector<std::vector<double>> latencies(client_count);
+    std::vector<std::thread> clients;
+    for (size_t i = 0; i < client_count; ++i) {
+        clients.emplace_back([&, i] {
+            ServerClient client(socket_path);
+            for (size_t j = 0; j < iterations; ++j) {
+                auto start = std::chrono::steady_clock::now();
+                ServerResponse response = client.Send(RequestKind::EVALUATE, kExpression);
+                std::chrono::duration<double, std::micro> elapsed =
+                    std::chrono::steady_clock::now() - start;
+                if (response.status != ResponseStatus::OK) {
+                    std::cerr << "unexpected response: " << response.payload;
+                    std::exit(1);
+                }
+                latencies[i].push_back(elapsed.count());
+            }
+        });
+    }
+    for (std::thread& client : clients) {
+        client.join();
+    }
+    std::vector<double> all;
+    for (const std::vector<double>& client_latencies : latencies) {
+        all.insert(all.end(), client_latencies.begin(), client_latencies.end());
+    }
+    return all;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultIterations;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        Interpreter().Run(kExpression);
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "in process: " << elapsed.count() / iterations << " us\n";
+
+    ServerOptions options;
+    options.socket_path = "/tmp/scheme_server_bench." + std::to_string(getpid());
+    options.worker_count = 2;
+    Server server(options);
+    std::thread serving([&] { server.Serve(); });
+    for (size_t client_count : {1, 2, 4}) {
+        std::vector<double> latencies = Measure(options.socket_path, client_count, iterations);
+        std::cout << client_count << " clients: p50 " << Percentile(latencies, 50) << " us, p99 "
+                  << Percentile(latencies, 99) << " us\n";
+    }
+    std::cout << FormatServerMetrics(server.GetMetrics());
+    server.Stop();
+    serving.join();
+    return 0;
+}
@@ -0,0 +1,40 @@
+// Runs a tail-recursive loop for a growing number of iterations and reports the time per
+// iteration and the peak RSS after each run. With proper tail calls the RSS stays flat.
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <scheme.h>
+
+namespace {
+
+const size_t kDefaultIterations = 10'000'000;
+
+size_t PeakRssKilobytes() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t max_iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultIterations;
+
+    Interpreter interpreter;
+    interpreter.Run("(define (loop n acc) (if (= n 0) acc (loop (- n 1) (+ acc 1))))");
+    for (size_t iterations = max_iterations / 1000; iterations <= max_iterations;
+         iterations *= 10) {
+        auto start = std::chrono::steady_clock::now();
+        std::string result = interpreter.Run("(loop " + std::to_string(iterations) + " 0)");
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << iterations << " iterations: " << elapsed.count() / iterations
+                  << " ns/iteration, peak RSS " << PeakRssKilobytes() << " KB (result " << result
+                  << ")\n";
+    }
+    return 0;
+}
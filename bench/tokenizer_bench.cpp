@@ -0,0 +1,79 @@
+// Tokenizer throughput in MB/s: reading through a std::stringstream built from the input, as
+// Interpreter::Run used to, against scanning the input buffer in place.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include <tokenizer.h>
+
+namespace {
+
+const size_t kDefaultSize = 16 << 20;
+const int kRepeats = 5;
+
+const std::string_view kSnippet =
+    "(define (sum-list lst acc) (if (null? lst) acc (sum-list (cdr lst) (+ acc (car lst)))))\n"
+    "(list 1 -2 +3 45678 'quoted-symbol (cons 1 2) '(a . b) #t #f)\n"
+    "(let ((x 10) (y 20)) (and (<= x y) (number? x) (max x y 1000000)))\n";
+
+std::string BuildSource(size_t size) {
+    std::string source;
+    source.reserve(size + kSnippet.size());
+    while (source.size() < size) {
+        source += kSnippet;
+    }
+    return source;
+}
+
+// Counts tokens, so the loop can't be optimized away.
+size_t Drain(Tokenizer* tokenizer) {
+    size_t count = 0;
+    while (!tokenizer->IsEnd()) {
+        ++count;
+        tokenizer->Next();
+    }
+    return count;
+}
+
+size_t ReadStream(const std::string& source) {
+    std::stringstream flow(source);
+    Tokenizer tokenizer(&flow);
+    return Drain(&tokenizer);
+}
+
+size_t ReadBuffer(const std::string& source) {
+    Tokenizer tokenizer{std::string_view(source)};
+    return Drain(&tokenizer);
+}
+
+template <class F>
+void Measure(const std::string& name, const std::string& source, F read) {
+    double best = 0;
+    size_t tokens = 0;
+    for (int i = 0; i < kRepeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        tokens = read(source);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (i == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    double megabytes = static_cast<double>(source.size()) / (1 << 20);
+    std::cout << name << ": " << megabytes / best << " MB/s, " << best * 1e9 / tokens
+              << " ns/token (" << tokens << " tokens)\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultSize;
+    std::string source = BuildSource(size);
+
+    Measure("istream", source, ReadStream);
+    Measure("buffer", source, ReadBuffer);
+    return 0;
+}
@@ -0,0 +1,101 @@
+// Compares the cost of asking "what kind of node is this?" while walking long lists:
+// the old RTTI-based checks (dynamic_pointer_cast) against the tag-based Is/As/View.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <object.h>
+
+namespace {
+
+const size_t kDefaultLength = 1'000'000;
+const int kRepeats = 5;
+
+// Flat list (1 2 3 ...) where every element is a Number, except each third one is a Symbol.
+std::shared_ptr<Object> BuildList(size_t length) {
+    std::shared_ptr<Object> list = nullptr;
+    for (size_t i = length; i > 0; --i) {
+        std::shared_ptr<Object> element;
+        if (i % 3 == 0) {
+            element = std::make_shared<Symbol>(PLUS);
+        } else {
+            element = std::make_shared<Number>(i);
+        }
+        list = std::make_shared<Cell>(element, list);
+    }
+    return list;
+}
+
+// The way Is/As were implemented before the type tag was introduced.
+int64_t SumWithDynamicCast(std::shared_ptr<Object> list) {
+    int64_t sum = 0;
+    while (std::dynamic_pointer_cast<Cell>(list) != nullptr) {
+        std::shared_ptr<Object> first = std::dynamic_pointer_cast<Cell>(list)->GetFirst();
+        if (std::dynamic_pointer_cast<Number>(first) != nullptr) {
+            sum += std::dynamic_pointer_cast<Number>(first)->GetValue();
+        }
+        list = std::dynamic_pointer_cast<Cell>(list)->GetSecond();
+    }
+    return sum;
+}
+
+int64_t SumWithAs(std::shared_ptr<Object> list) {
+    int64_t sum = 0;
+    while (Is<Cell>(list)) {
+        std::shared_ptr<Object> first = As<Cell>(list)->GetFirst();
+        if (Is<Number>(first)) {
+            sum += As<Number>(first)->GetValue();
+        }
+        list = As<Cell>(list)->GetSecond();
+    }
+    return sum;
+}
+
+int64_t SumWithView(const std::shared_ptr<Object>& list) {
+    int64_t sum = 0;
+    const Object* jumper = list.get();
+    while (Is<Cell>(jumper)) {
+        const Cell* cell = static_cast<const Cell*>(jumper);
+        if (Number* number = View<Number>(cell->GetFirst())) {
+            sum += number->GetValue();
+        }
+        jumper = cell->GetSecond().get();
+    }
+    return sum;
+}
+
+template <class F>
+void Measure(const std::string& name, const std::shared_ptr<Object>& list, size_t length, F walk) {
+    double best = 0;
+    int64_t checksum = 0;
+    for (int i = 0; i < kRepeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        checksum = walk(list);
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        if (i == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    std::cout << name << ": " << best / length << " ns/node (checksum " << checksum << ")\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t length = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultLength;
+    std::shared_ptr<Object> list = BuildList(length);
+
+    Measure("dynamic_pointer_cast", list, length, SumWithDynamicCast);
+    Measure("tag Is/As", list, length, SumWithAs);
+    Measure("tag View", list, length, SumWithView);
+
+    // destroying a long list recurses once per cell, unlink it iteratively
+    while (Is<Cell>(list)) {
+        list = As<Cell>(list)->GetSecond();
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+// Measures numeric vectors against the spread arguments they replace: (+ 1 2 ...) over a list
+// of numbers next to (+ #(1 2 ...)), the same for max and <, and elementwise + of two vectors
+// next to adding the numbers pair by pair.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <object.h>
+
+namespace {
+
+const size_t kDefaultIterations = 20'000;
+const size_t kElements = 1024;
+
+double NsPerCall(SymbolId function, const std::vector<std::shared_ptr<Object>>& arguments,
+                 size_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    size_t sink = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        sink += ApplyBuiltinFunction(function, arguments) != nullptr;
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    if (sink != iterations) {
+        std::cout << "unexpected result\n";
+    }
+    return elapsed.count() / iterations;
+}
+
+void Compare(const char* name, SymbolId function,
+             const std::vector<std::shared_ptr<Object>>& spread,
+             const std::vector<std::shared_ptr<Object>>& vector, size_t iterations) {
+    double spread_ns = NsPerCall(function, spread, iterations);
+    double vector_ns = NsPerCall(function, vector, iterations);
+    std::cout << name << ": " << spread_ns << " ns spread, " << vector_ns << " ns vector, "
+              << spread_ns / vector_ns << "x\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultIterations;
+
+    std::vector<std::shared_ptr<Object>> numbers;
+    for (size_t i = 0; i < kElements; ++i) {
+        numbers.push_back(MakeNumber(static_cast<int64_t>(i)));
+    }
+    std::vector<std::shared_ptr<Object>> vector = {ApplyBuiltinFunction(VECTOR, numbers)};
+
+    std::cout << kElements << " elements\n";
+    Compare("+", PLUS, numbers, vector, iterations);
+    Compare("max", MAX, numbers, vector, iterations);
+    Compare("<", LESS, numbers, vector, iterations);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        for (size_t j = 0; j < kElements; ++j) {
+            std::shared_ptr<Object> pair[] = {numbers[j], numbers[j]};
+            ApplyBuiltinFunction(PLUS, pair);
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    double pairs_ns = elapsed.count() / iterations;
+    double vector_ns = NsPerCall(PLUS, {vector[0], vector[0]}, iterations);
+    std::cout << "elementwise +: " << pairs_ns << " ns pair by pair, " << vector_ns
+              << " ns vector, " << pairs_ns / vector_ns << "x\n";
+    return 0;
+}
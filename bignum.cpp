@@ -0,0 +1,353 @@
+#include <bignum.h>
+
+#include <algorithm>
+#include <bit>
+#include <span>
+
+namespace {
+
+using Limbs = std::vector<uint32_t>;
+using LimbSpan = std::span<const uint32_t>;
+
+const int kLimbBits = 32;
+const uint64_t kLimbBase = uint64_t(1) << kLimbBits;
+const uint64_t kLimbMask = kLimbBase - 1;
+// with a shorter operand than this schoolbook multiplication is faster than splitting it
+const size_t kKaratsubaThreshold = 32;
+// the largest power of ten in a limb, used to convert nine decimal digits at a time
+const uint32_t kDecimalChunk = 1'000'000'000;
+const size_t kDecimalChunkDigits = 9;
+
+void Trim(Limbs* limbs) {
+    while (!limbs->empty() && limbs->back() == 0) {
+        limbs->pop_back();
+    }
+}
+
+LimbSpan Trimmed(LimbSpan limbs) {
+    while (!limbs.empty() && limbs.back() == 0) {
+        limbs = limbs.first(limbs.size() - 1);
+    }
+    return limbs;
+}
+
+int CompareMagnitudes(LimbSpan lhs, LimbSpan rhs) {
+    if (lhs.size() != rhs.size()) {
+        return lhs.size() < rhs.size() ? -1 : 1;
+    }
+    for (size_t i = lhs.size(); i-- > 0;) {
+        if (lhs[i] != rhs[i]) {
+            return lhs[i] < rhs[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// *result += addend * base^offset
+void AddInto(Limbs* result, LimbSpan addend, size_t offset) {
+    if (result->size() < offset + addend.size()) {
+        result->resize(offset + addend.size(), 0);
+    }
+    uint64_t carry = 0;
+    for (size_t i = 0; i < addend.size(); ++i) {
+        uint64_t sum = uint64_t((*result)[offset + i]) + addend[i] + carry;
+        (*result)[offset + i] = static_cast<uint32_t>(sum);
+        carry = sum >> kLimbBits;
+    }
+    for (size_t i = offset + addend.size(); carry; ++i) {
+        if (i == result->size()) {
+            result->push_back(0);
+        }
+        uint64_t sum = uint64_t((*result)[i]) + carry;
+        (*result)[i] = static_cast<uint32_t>(sum);
+        carry = sum >> kLimbBits;
+    }
+}
+
+// *result -= subtrahend, which must not be greater.
+void SubtractFrom(Limbs* result, LimbSpan subtrahend) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < subtrahend.size() || borrow; ++i) {
+        uint64_t limb = i < subtrahend.size() ? subtrahend[i] : 0;
+        uint64_t difference = (*result)[i] - limb - borrow;
+        (*result)[i] = static_cast<uint32_t>(difference);
+        // a wrapped difference has its top bit set
+        borrow = difference >> (2 * kLimbBits - 1);
+    }
+    Trim(result);
+}
+
+// *result = *result * factor + addend
+void MultiplyAdd(Limbs* result, uint32_t factor, uint32_t addend) {
+    uint64_t carry = addend;
+    for (uint32_t& limb : *result) {
+        uint64_t product = uint64_t(limb) * factor + carry;
+        limb = static_cast<uint32_t>(product);
+        carry = product >> kLimbBits;
+    }
+    if (carry) {
+        result->push_back(static_cast<uint32_t>(carry));
+    }
+}
+
+// Divides *result in place, returns the remainder.
+uint32_t DivideBySmall(Limbs* result, uint32_t divisor) {
+    uint64_t remainder = 0;
+    for (size_t i = result->size(); i-- > 0;) {
+        uint64_t current = (remainder << kLimbBits) | (*result)[i];
+        (*result)[i] = static_cast<uint32_t>(current / divisor);
+        remainder = current % divisor;
+    }
+    Trim(result);
+    return static_cast<uint32_t>(remainder);
+}
+
+Limbs MultiplySchoolbook(LimbSpan lhs, LimbSpan rhs) {
+    Limbs result(lhs.size() + rhs.size(), 0);
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < rhs.size(); ++j) {
+            // at most (2^32 - 1)^2 + 2 (2^32 - 1) = 2^64 - 1
+            uint64_t product = uint64_t(lhs[i]) * rhs[j] + result[i + j] + carry;
+            result[i + j] = static_cast<uint32_t>(product);
+            carry = product >> kLimbBits;
+        }
+        result[i + rhs.size()] = static_cast<uint32_t>(carry);
+    }
+    Trim(&result);
+    return result;
+}
+
+Limbs MultiplyMagnitudes(LimbSpan lhs, LimbSpan rhs) {
+    lhs = Trimmed(lhs);
+    rhs = Trimmed(rhs);
+    if (lhs.size() < rhs.size()) {
+        std::swap(lhs, rhs);
+    }
+    if (rhs.empty()) {
+        return {};
+    }
+    if (rhs.size() < kKaratsubaThreshold) {
+        return MultiplySchoolbook(lhs, rhs);
+    }
+    if (2 * rhs.size() <= lhs.size()) {
+        // lopsided operands: multiply rhs by slices of lhs as long as itself
+        Limbs result;
+        for (size_t offset = 0; offset < lhs.size(); offset += rhs.size()) {
+            LimbSpan slice = lhs.subspan(offset, std::min(rhs.size(), lhs.size() - offset));
+            AddInto(&result, MultiplyMagnitudes(slice, rhs), offset);
+        }
+        Trim(&result);
+        return result;
+    }
+    // Karatsuba: with x = x1 B + x0 and y = y1 B + y0, x y = z2 B^2 + (z1 - z2 - z0) B + z0,
+    // where z2 = x1 y1, z0 = x0 y0 and z1 = (x1 + x0)(y1 + y0): three products instead of four
+    size_t half = lhs.size() / 2;
+    LimbSpan lhs_low = lhs.first(half);
+    LimbSpan lhs_high = lhs.subspan(half);
+    LimbSpan rhs_low = rhs.first(half);
+    LimbSpan rhs_high = rhs.subspan(half);
+    Limbs low = MultiplyMagnitudes(lhs_low, rhs_low);
+    Limbs high = MultiplyMagnitudes(lhs_high, rhs_high);
+    Limbs lhs_sum(lhs_low.begin(), lhs_low.end());
+    AddInto(&lhs_sum, lhs_high, 0);
+    Limbs rhs_sum(rhs_low.begin(), rhs_low.end());
+    AddInto(&rhs_sum, rhs_high, 0);
+    Limbs middle = MultiplyMagnitudes(lhs_sum, rhs_sum);
+    SubtractFrom(&middle, low);
+    SubtractFrom(&middle, high);
+    Limbs result = std::move(low);
+    AddInto(&result, middle, half);
+    AddInto(&result, high, 2 * half);
+    Trim(&result);
+    return result;
+}
+
+// limbs * 2^shift, one limb longer than limbs.
+Limbs ShiftLeft(LimbSpan limbs, int shift) {
+    Limbs result(limbs.size() + 1, 0);
+    for (size_t i = 0; i < limbs.size(); ++i) {
+        uint64_t shifted = uint64_t(limbs[i]) << shift;
+        result[i] |= static_cast<uint32_t>(shifted);
+        result[i + 1] = static_cast<uint32_t>(shifted >> kLimbBits);
+    }
+    return result;
+}
+
+// The truncated quotient, by Knuth's algorithm D.
+Limbs DivideMagnitudes(const Limbs& dividend, const Limbs& divisor) {
+    if (CompareMagnitudes(dividend, divisor) < 0) {
+        return {};
+    }
+    if (divisor.size() == 1) {
+        Limbs quotient = dividend;
+        DivideBySmall(&quotient, divisor[0]);
+        return quotient;
+    }
+    // scaled so the top bit of the divisor is set, which keeps each estimated quotient digit
+    // at most two above the real one
+    int shift = std::countl_zero(divisor.back());
+    Limbs v = ShiftLeft(divisor, shift);
+    v.pop_back();
+    Limbs u = ShiftLeft(dividend, shift);
+    size_t n = v.size();
+    size_t m = dividend.size() - n;
+    Limbs quotient(m + 1, 0);
+    for (size_t j = m + 1; j-- > 0;) {
+        uint64_t numerator = (uint64_t(u[j + n]) << kLimbBits) | u[j + n - 1];
+        uint64_t estimate = numerator / v[n - 1];
+        uint64_t remainder = numerator % v[n - 1];
+        while (estimate >= kLimbBase ||
+               estimate * v[n - 2] > ((remainder << kLimbBits) | u[j + n - 2])) {
+            --estimate;
+            remainder += v[n - 1];
+            if (remainder >= kLimbBase) {
+                break;
+            }
+        }
+        int64_t borrow = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t product = estimate * v[i];
+            int64_t difference = int64_t(u[i + j]) - borrow - int64_t(product & kLimbMask);
+            u[i + j] = static_cast<uint32_t>(difference);
+            borrow = int64_t(product >> kLimbBits) - (difference >> kLimbBits);
+        }
+        int64_t top = int64_t(u[j + n]) - borrow;
+        u[j + n] = static_cast<uint32_t>(top);
+        if (top < 0) {
+            // the estimate was one too large, add the divisor back
+            --estimate;
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t sum = uint64_t(u[i + j]) + v[i] + carry;
+                u[i + j] = static_cast<uint32_t>(sum);
+                carry = sum >> kLimbBits;
+            }
+            u[j + n] += static_cast<uint32_t>(carry);
+        }
+        quotient[j] = static_cast<uint32_t>(estimate);
+    }
+    Trim(&quotient);
+    return quotient;
+}
+
+}  // namespace
+
+BigInteger::BigInteger(int64_t value) : negative_{value < 0} {
+    // negated as unsigned, so INT64_MIN is fine too
+    uint64_t magnitude = negative_ ? 0 - static_cast<uint64_t>(value) : value;
+    for (; magnitude; magnitude >>= kLimbBits) {
+        limbs_.push_back(static_cast<uint32_t>(magnitude));
+    }
+}
+
+BigInteger::BigInteger(bool negative, Limbs limbs) : limbs_{std::move(limbs)} {
+    Trim(&limbs_);
+    negative_ = negative && !limbs_.empty();
+}
+
+std::optional<BigInteger> BigInteger::Parse(std::string_view digits) {
+    if (digits.empty() || !std::all_of(digits.begin(), digits.end(),
+                                       [](char c) { return '0' <= c && c <= '9'; })) {
+        return std::nullopt;
+    }
+    Limbs limbs;
+    size_t chunk_size = digits.size() % kDecimalChunkDigits;
+    if (chunk_size == 0) {
+        chunk_size = kDecimalChunkDigits;
+    }
+    for (size_t begin = 0; begin < digits.size(); begin += chunk_size) {
+        chunk_size = begin ? kDecimalChunkDigits : chunk_size;
+        uint32_t chunk = 0;
+        uint32_t scale = 1;
+        for (char c : digits.substr(begin, chunk_size)) {
+            chunk = chunk * 10 + (c - '0');
+            scale *= 10;
+        }
+        MultiplyAdd(&limbs, scale, chunk);
+    }
+    return BigInteger(false, std::move(limbs));
+}
+
+bool BigInteger::FitsInt64() const {
+    if (limbs_.size() > 2) {
+        return false;
+    }
+    uint64_t magnitude = 0;
+    for (size_t i = limbs_.size(); i-- > 0;) {
+        magnitude = (magnitude << kLimbBits) | limbs_[i];
+    }
+    uint64_t limit = uint64_t(INT64_MAX) + (negative_ ? 1 : 0);
+    return magnitude <= limit;
+}
+
+int64_t BigInteger::ToInt64() const {
+    uint64_t magnitude = 0;
+    for (size_t i = limbs_.size(); i-- > 0;) {
+        magnitude = (magnitude << kLimbBits) | limbs_[i];
+    }
+    return static_cast<int64_t>(negative_ ? 0 - magnitude : magnitude);
+}
+
+std::string BigInteger::ToString() const {
+    if (limbs_.empty()) {
+        return "0";
+    }
+    // nine digit chunks, least significant first
+    std::vector<uint32_t> chunks;
+    Limbs rest = limbs_;
+    while (!rest.empty()) {
+        chunks.push_back(DivideBySmall(&rest, kDecimalChunk));
+    }
+    std::string result = negative_ ? "-" : "";
+    result += std::to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i-- > 0;) {
+        std::string chunk = std::to_string(chunks[i]);
+        result.append(kDecimalChunkDigits - chunk.size(), '0');
+        result += chunk;
+    }
+    return result;
+}
+
+BigInteger BigInteger::operator-() const {
+    return BigInteger(!negative_, limbs_);
+}
+
+BigInteger BigInteger::Abs() const {
+    return BigInteger(false, limbs_);
+}
+
+BigInteger operator+(const BigInteger& lhs, const BigInteger& rhs) {
+    if (lhs.negative_ == rhs.negative_) {
+        BigInteger::Limbs sum = lhs.limbs_;
+        AddInto(&sum, rhs.limbs_, 0);
+        return BigInteger(lhs.negative_, std::move(sum));
+    }
+    // opposite signs: the larger magnitude decides the sign of the difference
+    bool is_lhs_larger = CompareMagnitudes(lhs.limbs_, rhs.limbs_) >= 0;
+    const BigInteger& larger = is_lhs_larger ? lhs : rhs;
+    const BigInteger& smaller = is_lhs_larger ? rhs : lhs;
+    BigInteger::Limbs difference = larger.limbs_;
+    SubtractFrom(&difference, smaller.limbs_);
+    return BigInteger(larger.negative_, std::move(difference));
+}
+
+BigInteger operator-(const BigInteger& lhs, const BigInteger& rhs) {
+    return lhs + -rhs;
+}
+
+BigInteger operator*(const BigInteger& lhs, const BigInteger& rhs) {
+    return BigInteger(lhs.negative_ != rhs.negative_, MultiplyMagnitudes(lhs.limbs_, rhs.limbs_));
+}
+
+BigInteger operator/(const BigInteger& lhs, const BigInteger& rhs) {
+    return BigInteger(lhs.negative_ != rhs.negative_, DivideMagnitudes(lhs.limbs_, rhs.limbs_));
+}
+
+int Compare(const BigInteger& lhs, const BigInteger& rhs) {
+    if (lhs.negative_ != rhs.negative_) {
+        return lhs.negative_ ? -1 : 1;
+    }
+    int magnitude_order = CompareMagnitudes(lhs.limbs_, rhs.limbs_);
+    return lhs.negative_ ? -magnitude_order : magnitude_order;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Arbitrary-precision integer in sign and magnitude form. Numbers only turn into one when an
+// int64_t can't hold them, so none of this is on the path of ordinary arithmetic.
+class BigInteger {
+public:
+    BigInteger() = default;
+    BigInteger(int64_t value);
+
+    // Decimal digits without a sign; nullopt if there is anything else.
+    static std::optional<BigInteger> Parse(std::string_view digits);
+
+    bool IsNegative() const {
+        return negative_;
+    }
+    bool IsZero() const {
+        return limbs_.empty();
+    }
+    bool FitsInt64() const;
+    // Only meaningful when FitsInt64().
+    int64_t ToInt64() const;
+    std::string ToString() const;
+
+    BigInteger operator-() const;
+    BigInteger Abs() const;
+
+    friend BigInteger operator+(const BigInteger& lhs, const BigInteger& rhs);
+    friend BigInteger operator-(const BigInteger& lhs, const BigInteger& rhs);
+    friend BigInteger operator*(const BigInteger& lhs, const BigInteger& rhs);
+    // Truncates towards zero like the built-in division; rhs must not be zero.
+    friend BigInteger operator/(const BigInteger& lhs, const BigInteger& rhs);
+
+    // Negative, zero or positive as lhs is less than, equal to or greater than rhs.
+    friend int Compare(const BigInteger& lhs, const BigInteger& rhs);
+    friend bool operator==(const BigInteger& lhs, const BigInteger& rhs) = default;
+
+private:
+    // base 2^32 digits, least significant first, without leading zeros
+    using Limbs = std::vector<uint32_t>;
+
+    BigInteger(bool negative, Limbs limbs);
+
+    bool negative_ = false;  // never set for zero
+    Limbs limbs_;
+};
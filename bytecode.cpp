@@ -0,0 +1,669 @@
+#include <bytecode.h>
+
+#include <algorithm>
+#include <functional>
+
+#include "deadline.h"
+#include "profiler.h"
+
+namespace {
+
+// Names bound by one lambda or let, in slot order.
+using Scope = std::vector<SymbolId>;
+
+// how deeply lambdas and lets may nest in one another
+const size_t kMaxScopeDepth = 1000;
+
+bool IsBooleanLiteral(const std::shared_ptr<Object>& object) {
+    Symbol* symbol = View<Symbol>(object);
+    return symbol && (symbol->GetId() == TRUE_LITERAL || symbol->GetId() == FALSE_LITERAL);
+}
+
+// True if the value of object can't be a #t/#f symbol, so DefinitePointer would leave it as it
+// is. Variables only ever hold converted values, and only the builtins which return a part of
+// their arguments can hand such a symbol back.
+bool IsDefinite(const std::shared_ptr<Object>& object) {
+    if (IsQuoteForm(object)) {
+        return !IsBooleanLiteral(QuotedDatum(object));
+    }
+    Cell* cell = View<Cell>(object);
+    if (!cell) {
+        return !IsBooleanLiteral(object);
+    }
+    return IsBuiltinCall(cell->GetFirst()) &&
+           !ReturnsArgument(View<Symbol>(cell->GetFirst())->GetId());
+}
+
+SymbolId CheckBindable(const std::shared_ptr<Object>& name) {
+    if (!Is<Symbol>(name)) {
+        throw SyntaxError("only a symbol can be bound to a value\n");
+    }
+    SymbolId id = View<Symbol>(name)->GetId();
+    if (!IsVariableName(id)) {
+        throw SyntaxError("builtin names can't be rebound\n");
+    }
+    return id;
+}
+
+// The operands of a special form, (name first second ...), checked to be a proper list.
+std::vector<std::shared_ptr<Object>> SpecialFormOperands(const Cell& form) {
+    if (!IsProperList(form.GetSecond())) {
+        throw SyntaxError("a special form can't be a dotted list\n");
+    }
+    std::vector<std::shared_ptr<Object>> operands;
+    for (std::shared_ptr<Object> jumper = form.GetSecond(); jumper;
+         jumper = View<Cell>(jumper)->GetSecond()) {
+        operands.push_back(View<Cell>(jumper)->GetFirst());
+    }
+    return operands;
+}
+
+// Compiles with an explicit stack of steps instead of native recursion, so an expression nested
+// however deeply compiles in bounded native stack, as Read reads it. A form compiles what it can
+// at once and schedules the rest: its subexpressions, and what comes after each of them.
+class Compiler {
+public:
+    explicit Compiler(std::vector<Scope> scopes = {},
+                      std::shared_ptr<const SourceMap> source_map = nullptr, SourceSpan span = {})
+        : scopes_{std::move(scopes)}, source_map_{std::move(source_map)}, span_{span} {
+        program_.source_map = source_map_;
+        steps_.reserve(kStepsReserved);
+    }
+
+    // Compiles a whole top-level form, the only place a define may be.
+    void CompileTopLevel(const std::shared_ptr<Object>& form) {
+        top_level_form_ = form.get();
+        Schedule({Expression(form, true)});
+        Run();
+    }
+
+    // Compiles the body of a function, whose last expression is in tail position.
+    void CompileFunctionBody(const std::shared_ptr<Object>& body) {
+        CompileBody(body, true);
+        Run();
+    }
+
+    Program Finish() {
+        Emit({OpCode::RETURN}, 0);
+        return std::move(program_);
+    }
+
+private:
+    // enough for most forms, so that steps_ doesn't grow a few times on each of them
+    static constexpr size_t kStepsReserved = 8;
+
+    // Compiles an expression, emits an instruction, or goes on with a form whose earlier parts
+    // are compiled.
+    struct Step {
+        enum class Kind : uint8_t { EXPRESSION, EMIT, THEN } kind;
+        std::shared_ptr<Object> object;
+        bool is_tail = false;
+        Instruction instruction{};
+        int stack_effect = 0;
+        std::function<void()> then;
+    };
+
+    static Step Expression(std::shared_ptr<Object> object, bool is_tail = false) {
+        return {Step::Kind::EXPRESSION, std::move(object), is_tail, {}, 0, nullptr};
+    }
+    static Step EmitLater(Instruction instruction, int stack_effect) {
+        return {Step::Kind::EMIT, nullptr, false, instruction, stack_effect, nullptr};
+    }
+    static Step Then(std::function<void()> then) {
+        return {Step::Kind::THEN, nullptr, false, {}, 0, std::move(then)};
+    }
+
+    // Makes steps the next ones to be taken, in their order.
+    void Schedule(std::initializer_list<Step> steps) {
+        for (auto step = std::rbegin(steps); step != std::rend(steps); ++step) {
+            steps_.push_back(*step);
+        }
+    }
+
+    // Steps of a form too long for Schedule are pushed in their order, from the size StartList
+    // returns, and ScheduleList turns them around.
+    size_t StartList() const {
+        return steps_.size();
+    }
+
+    // Adds an expression to the list. An atom with nothing before it is compiled at once, since
+    // it schedules nothing, so a wide call of atoms compiles without steps.
+    void AddExpression(size_t list, const std::shared_ptr<Object>& object) {
+        if (steps_.size() == list && !Is<Cell>(object)) {
+            CompileAtom(object);
+            return;
+        }
+        steps_.push_back(Expression(object));
+    }
+
+    void ScheduleList(size_t list) {
+        std::reverse(steps_.begin() + list, steps_.end());
+    }
+
+    void Run() {
+        while (!steps_.empty()) {
+            Step step = std::move(steps_.back());
+            steps_.pop_back();
+            switch (step.kind) {
+                case Step::Kind::EXPRESSION:
+                    Compile(step.object, step.is_tail);
+                    break;
+                case Step::Kind::EMIT:
+                    Emit(step.instruction, step.stack_effect);
+                    break;
+                case Step::Kind::THEN:
+                    step.then();
+                    break;
+            }
+        }
+    }
+
+    // `is_tail` is set when the value of object is what the current function returns.
+    void Compile(const std::shared_ptr<Object>& object, bool is_tail) {
+        const SourceSpan* span = source_map_ ? source_map_->Find(object.get()) : nullptr;
+        if (!span) {
+            CompileExpression(object, is_tail);
+            return;
+        }
+        // scheduled first, so it's taken after whatever compiling object schedules
+        steps_.push_back(Then([this, outer_span = span_] { span_ = outer_span; }));
+        span_ = *span;
+        CompileExpression(object, is_tail);
+    }
+
+    void CompileBody(const std::shared_ptr<Object>& body, bool is_tail) {
+        if (!Is<Cell>(body) || !IsProperList(body)) {
+            throw SyntaxError("a body must be a non-empty list of expressions\n");
+        }
+        size_t list = StartList();
+        for (std::shared_ptr<Object> jumper = body; jumper;
+             jumper = View<Cell>(jumper)->GetSecond()) {
+            bool is_last = !View<Cell>(jumper)->GetSecond();
+            steps_.push_back(Expression(View<Cell>(jumper)->GetFirst(), is_tail && is_last));
+            if (!is_last) {
+                steps_.push_back(EmitLater({OpCode::POP}, -1));
+            }
+        }
+        ScheduleList(list);
+    }
+
+    void CompileExpression(const std::shared_ptr<Object>& object, bool is_tail) {
+        if (IsQuoteForm(object)) {
+            PushConstant(QuotedDatum(object));
+            return;
+        }
+        Cell* cell = View<Cell>(object);
+        if (!cell) {
+            CompileAtom(object);
+            return;
+        }
+        if (Symbol* head = View<Symbol>(cell->GetFirst())) {
+            if (IsSpecialForm(head->GetId())) {
+                CompileSpecialForm(head->GetId(), *cell, is_tail);
+                return;
+            }
+            if (IsVariableName(head->GetId()) && IsProperList(cell->GetSecond())) {
+                CompileApplication(*cell, is_tail);
+                return;
+            }
+        }
+        if (IsBuiltinCall(cell->GetFirst()) && TryCompileCall(*cell)) {
+            return;
+        }
+        Schedule({Expression(cell->GetFirst()), Expression(cell->GetSecond()),
+                  EmitLater({OpCode::EVAL_PAIR}, -1)});
+    }
+
+    void CompileAtom(const std::shared_ptr<Object>& object) {
+        Symbol* symbol = View<Symbol>(object);
+        if (!symbol || !IsVariableName(symbol->GetId())) {
+            PushConstant(object);
+            return;
+        }
+        SymbolId id = symbol->GetId();
+        for (size_t depth = 0; depth < scopes_.size(); ++depth) {
+            const Scope& scope = scopes_[scopes_.size() - 1 - depth];
+            auto slot = std::find(scope.begin(), scope.end(), id);
+            if (slot != scope.end()) {
+                Emit({OpCode::LOAD_LOCAL, id, static_cast<uint32_t>(slot - scope.begin()),
+                      static_cast<uint32_t>(depth)},
+                     1);
+                return;
+            }
+        }
+        // an undefined global evaluates to its own name, as every symbol did before sessions
+        Emit({OpCode::LOAD_GLOBAL, id, AddConstant(object)}, 1);
+    }
+
+    // (f a b ...) with a proper argument list, none of which can turn the argument list itself
+    // into a call, is compiled to its arguments followed by a single CALL.
+    bool TryCompileCall(const Cell& call) {
+        uint32_t count = 0;
+        bool is_definite = true;
+        for (std::shared_ptr<Object> jumper = call.GetSecond(); jumper;
+             jumper = View<Cell>(jumper)->GetSecond()) {
+            if (!Is<Cell>(jumper) || IsQuoteForm(jumper) ||
+                MayYieldBuiltin(View<Cell>(jumper)->GetFirst())) {
+                return false;
+            }
+            is_definite = is_definite && IsDefinite(View<Cell>(jumper)->GetFirst());
+            ++count;
+        }
+        size_t list = StartList();
+        for (std::shared_ptr<Object> jumper = call.GetSecond(); jumper;
+             jumper = View<Cell>(jumper)->GetSecond()) {
+            AddExpression(list, View<Cell>(jumper)->GetFirst());
+        }
+        steps_.push_back(EmitLater({is_definite ? OpCode::CALL_DEFINITE : OpCode::CALL,
+                                   View<Symbol>(call.GetFirst())->GetId(), count},
+                                  1 - static_cast<int>(count)));
+        ScheduleList(list);
+        return true;
+    }
+
+    // (f a b ...) where f is a variable: evaluated as ordinary Scheme application.
+    void CompileApplication(const Cell& application, bool is_tail) {
+        CompileAtom(application.GetFirst());
+        uint32_t count = 0;
+        size_t list = StartList();
+        for (std::shared_ptr<Object> jumper = application.GetSecond(); jumper;
+             jumper = View<Cell>(jumper)->GetSecond()) {
+            AddExpression(list, View<Cell>(jumper)->GetFirst());
+            ++count;
+        }
+        steps_.push_back(EmitLater({is_tail ? OpCode::TAIL_CALL : OpCode::CALL_VALUE, 0, count},
+                                  -static_cast<int>(count)));
+        ScheduleList(list);
+    }
+
+    void CompileSpecialForm(SymbolId form, const Cell& cell, bool is_tail) {
+        std::vector<std::shared_ptr<Object>> operands = SpecialFormOperands(cell);
+        // everything after the first operand, the body of define, lambda and let
+        std::shared_ptr<Object> body =
+            operands.empty() ? nullptr : View<Cell>(cell.GetSecond())->GetSecond();
+        switch (form) {
+            case DEFINE:
+                CompileDefine(cell, operands, body);
+                break;
+            case LAMBDA:
+                if (operands.size() < 2) {
+                    throw SyntaxError("lambda must have parameters and a body\n");
+                }
+                CompileLambda(operands[0], body);
+                break;
+            case LET:
+                if (operands.size() < 2) {
+                    throw SyntaxError("let must have bindings and a body\n");
+                }
+                CompileLet(operands[0], body, is_tail);
+                break;
+            case IF:
+                CompileIf(operands, is_tail);
+                break;
+        }
+    }
+
+    // (define name value) or (define (name parameters...) body...)
+    void CompileDefine(const Cell& form, const std::vector<std::shared_ptr<Object>>& operands,
+                       const std::shared_ptr<Object>& body) {
+        // a define within an expression could bind a global and then have the rest of the
+        // expression throw
+        if (!scopes_.empty() || &form != top_level_form_) {
+            throw SyntaxError("define is only allowed at the top level\n");
+        }
+        if (operands.size() < 2) {
+            throw SyntaxError("define must have a name and a value\n");
+        }
+        if (Cell* signature = View<Cell>(operands[0])) {
+            CompileLambda(signature->GetSecond(), body);
+            EmitDefine(signature->GetFirst());
+        } else if (operands.size() == 2) {
+            Schedule({Expression(operands[1]), Then([this, name = operands[0]] {
+                          EmitDefine(name);
+                      })});
+        } else {
+            throw SyntaxError("define of a variable must have exactly one value\n");
+        }
+    }
+
+    // binds name to the value on the stack
+    void EmitDefine(const std::shared_ptr<Object>& name) {
+        Emit({OpCode::DEFINE_GLOBAL, CheckBindable(name), AddConstant(name)}, 0);
+        program_.defines_globals = true;
+    }
+
+    void CompileLambda(const std::shared_ptr<Object>& parameters,
+                       const std::shared_ptr<Object>& body) {
+        if (!IsProperList(parameters)) {
+            throw SyntaxError("lambda parameters must be a list of symbols\n");
+        }
+        CheckScopeDepth();
+        Scope scope;
+        for (std::shared_ptr<Object> jumper = parameters; jumper;
+             jumper = View<Cell>(jumper)->GetSecond()) {
+            scope.push_back(CheckBindable(View<Cell>(jumper)->GetFirst()));
+        }
+        std::vector<Scope> scopes = scopes_;
+        scopes.push_back(scope);
+        // a compiler of its own, so this recurses once per function nested in another, which
+        // CheckScopeDepth bounds
+        Compiler body_compiler(std::move(scopes), source_map_, span_);
+        body_compiler.CompileFunctionBody(body);
+        Program function = body_compiler.Finish();
+        function.parameter_count = scope.size();
+
+        program_.functions.push_back(std::make_shared<const Program>(std::move(function)));
+        Emit({OpCode::MAKE_CLOSURE, 0, static_cast<uint32_t>(program_.functions.size() - 1)}, 1);
+    }
+
+    // (let ((name value) ...) body...)
+    void CompileLet(const std::shared_ptr<Object>& bindings, const std::shared_ptr<Object>& body,
+                    bool is_tail) {
+        if (!IsProperList(bindings)) {
+            throw SyntaxError("let bindings must be a list\n");
+        }
+        CheckScopeDepth();
+        auto scope = std::make_shared<Scope>();
+        size_t list = StartList();
+        for (std::shared_ptr<Object> jumper = bindings; jumper;
+             jumper = View<Cell>(jumper)->GetSecond()) {
+            steps_.push_back(Then([this, binding = View<Cell>(jumper)->GetFirst(), scope] {
+                Cell* cell = View<Cell>(binding);
+                if (!cell || !Is<Cell>(cell->GetSecond()) ||
+                    View<Cell>(cell->GetSecond())->GetSecond()) {
+                    throw SyntaxError("a let binding must look like (name value)\n");
+                }
+                Schedule({Expression(View<Cell>(cell->GetSecond())->GetFirst()),
+                          Then([scope, name = cell->GetFirst()] {
+                              scope->push_back(CheckBindable(name));
+                          })});
+            }));
+        }
+        steps_.push_back(Then([this, body, is_tail, scope] {
+            Emit({OpCode::ENTER_FRAME, 0, static_cast<uint32_t>(scope->size())},
+                 -static_cast<int>(scope->size()));
+            scopes_.push_back(std::move(*scope));
+            Schedule({Then([this] { scopes_.pop_back(); }), EmitLater({OpCode::LEAVE_FRAME}, 0)});
+            // a tail call in the body replaces the let frame along with the function
+            CompileBody(body, is_tail);
+        }));
+        ScheduleList(list);
+    }
+
+    // (if condition consequent [alternative])
+    void CompileIf(const std::vector<std::shared_ptr<Object>>& operands, bool is_tail) {
+        if (operands.size() != 2 && operands.size() != 3) {
+            throw SyntaxError("if must have a condition and one or two branches\n");
+        }
+        auto jump_to_alternative = std::make_shared<size_t>();
+        auto jump_to_end = std::make_shared<size_t>();
+        size_t list = StartList();
+        steps_.push_back(Expression(operands[0]));
+        steps_.push_back(Then([this, jump_to_alternative] {
+            *jump_to_alternative = Emit({OpCode::JUMP_IF_FALSE}, -1);
+        }));
+        steps_.push_back(Expression(operands[1], is_tail));
+        steps_.push_back(Then([this, jump_to_alternative, jump_to_end] {
+            *jump_to_end = Emit({OpCode::JUMP}, 0);
+            // only one of the branches leaves its value on the stack
+            --stack_size_;
+            program_.code[*jump_to_alternative].operand = program_.code.size();
+        }));
+        if (operands.size() == 3) {
+            steps_.push_back(Expression(operands[2], is_tail));
+        } else {
+            steps_.push_back(Then([this] { PushConstant(nullptr); }));
+        }
+        steps_.push_back(Then([this, jump_to_end] {
+            program_.code[*jump_to_end].operand = program_.code.size();
+        }));
+        ScheduleList(list);
+    }
+
+    // Frames and functions nested in one another are freed recursively, so there is a limit to
+    // how deeply lambdas and lets may nest.
+    void CheckScopeDepth() const {
+        if (scopes_.size() >= kMaxScopeDepth) {
+            throw SyntaxError("lambdas and lets are nested too deeply\n");
+        }
+    }
+
+    uint32_t AddConstant(const std::shared_ptr<Object>& object) {
+        program_.constants.push_back(object);
+        return program_.constants.size() - 1;
+    }
+
+    void PushConstant(const std::shared_ptr<Object>& object) {
+        Emit({OpCode::PUSH_CONSTANT, 0, AddConstant(object)}, 1);
+    }
+
+    size_t Emit(Instruction instruction, int stack_effect) {
+        program_.code.push_back(instruction);
+        if (source_map_) {
+            program_.spans.push_back(span_);
+        }
+        stack_size_ += stack_effect;
+        program_.max_stack_size = std::max(program_.max_stack_size, stack_size_);
+        return program_.code.size() - 1;
+    }
+
+    Program program_;
+    size_t stack_size_ = 0;
+    std::vector<Scope> scopes_;
+    const Object* top_level_form_ = nullptr;
+    std::shared_ptr<const SourceMap> source_map_;
+    // of the innermost list being compiled
+    SourceSpan span_;
+    // the next step last
+    std::vector<Step> steps_;
+};
+
+// A running function: which code, where in it, and the frame its variables live in.
+struct Activation {
+    const Program* program;
+    size_t pc;
+    std::shared_ptr<Frame> environment;
+    std::shared_ptr<const Program> program_owner;
+};
+
+// The expression each running function is at: the call a caller waits for, and for the current
+// function the instruction it has just executed.
+std::vector<ProfileFrame> GetProfileFrames(const std::vector<Activation>& calls) {
+    std::vector<ProfileFrame> frames;
+    for (const Activation& activation : calls) {
+        const Program& program = *activation.program;
+        if (program.spans.empty()) {
+            continue;
+        }
+        SourceSpan span = program.spans[activation.pc ? activation.pc - 1 : 0];
+        if (!span.IsEmpty()) {
+            frames.push_back({program.source_map.get(), span});
+        }
+    }
+    return frames;
+}
+
+}  // namespace
+
+Program Compile(const std::shared_ptr<Object>& ast, std::shared_ptr<const SourceMap> source_map) {
+    Compiler compiler({}, std::move(source_map));
+    compiler.CompileTopLevel(ast);
+    return compiler.Finish();
+}
+
+std::shared_ptr<Object> Execute(const Program& program, GlobalEnvironment* globals) {
+    // values made while running go to the heap and are freed as soon as they are dropped, so a
+    // long loop runs in flat memory; arenas only hold what the reader builds
+    ArenaScope heap_scope(nullptr);
+    std::vector<std::shared_ptr<Object>> stack;
+    stack.reserve(program.max_stack_size);
+    std::vector<std::shared_ptr<Object>> argument_collector;
+    std::vector<Activation> calls;
+    calls.push_back({&program, 0, nullptr, nullptr});
+    Activation* current = &calls.back();
+    ProfileScope* profile = ProfileScope::Current();
+    DeadlineScope* deadline = DeadlineScope::Current();
+
+    // Applies the value below the top `count` values of the stack to them. A tail call reuses the
+    // activation of the caller, so a loop written as tail recursion runs in constant space.
+    auto call_value = [&](size_t count, bool is_tail) {
+        size_t first_argument = stack.size() - count;
+        for (size_t i = first_argument; i < stack.size(); ++i) {
+            stack[i] = DefinitePointer(stack[i]);
+        }
+        std::shared_ptr<Object>& head = stack[first_argument - 1];
+        if (IsBuiltinCall(head)) {
+            std::shared_ptr<Object> result = ApplyBuiltinFunction(
+                View<Symbol>(head)->GetId(), Arguments(stack.data() + first_argument, count));
+            stack.resize(first_argument);
+            stack.back() = std::move(result);
+            return;
+        }
+        Closure* closure = View<Closure>(head);
+        if (!closure) {
+            throw RuntimeError("this object can't be applied\n");
+        }
+        if (closure->GetProgram()->parameter_count != count) {
+            throw RuntimeError("wrong number of arguments\n");
+        }
+        std::shared_ptr<Frame> frame = std::make_shared<Frame>();
+        frame->slots.assign(std::make_move_iterator(stack.begin() + first_argument),
+                            std::make_move_iterator(stack.end()));
+        frame->parent = closure->GetEnvironment();
+        std::shared_ptr<const Program> callee = closure->GetProgram();
+        stack.resize(first_argument - 1);
+        if (is_tail) {
+            *current = {callee.get(), 0, std::move(frame), std::move(callee)};
+            return;
+        }
+        calls.push_back({callee.get(), 0, std::move(frame), std::move(callee)});
+        current = &calls.back();
+    };
+
+    while (true) {
+        if (profile && profile->IsSampleDue()) {
+            profile->Sample(GetProfileFrames(calls));
+        }
+        if (deadline) {
+            deadline->Check();
+        }
+        const Instruction& instruction = current->program->code[current->pc++];
+        switch (instruction.code) {
+            case OpCode::PUSH_CONSTANT:
+                stack.push_back(current->program->constants[instruction.operand]);
+                break;
+            case OpCode::LOAD_LOCAL: {
+                const Frame* frame = current->environment.get();
+                for (uint32_t i = 0; i < instruction.depth; ++i) {
+                    frame = frame->parent.get();
+                }
+                stack.push_back(frame->slots[instruction.operand]);
+                break;
+            }
+            case OpCode::LOAD_GLOBAL: {
+                const std::shared_ptr<Object>* value = globals->Find(instruction.symbol);
+                stack.push_back(value ? *value
+                                      : current->program->constants[instruction.operand]);
+                break;
+            }
+            case OpCode::DEFINE_GLOBAL:
+                globals->Define(instruction.symbol, DefinitePointer(stack.back()));
+                stack.back() = current->program->constants[instruction.operand];
+                break;
+            case OpCode::MAKE_CLOSURE:
+                stack.push_back(New<Closure>(current->program->functions[instruction.operand],
+                                             current->environment, globals));
+                break;
+            case OpCode::CALL:
+                for (size_t i = stack.size() - instruction.operand; i < stack.size(); ++i) {
+                    stack[i] = DefinitePointer(stack[i]);
+                }
+                [[fallthrough]];
+            case OpCode::CALL_DEFINITE: {
+                size_t first_argument = stack.size() - instruction.operand;
+                std::shared_ptr<Object> result = ApplyBuiltinFunction(
+                    instruction.symbol,
+                    Arguments(stack.data() + first_argument, instruction.operand));
+                stack.resize(first_argument);
+                stack.push_back(std::move(result));
+                break;
+            }
+            case OpCode::CALL_VALUE:
+                call_value(instruction.operand, false);
+                break;
+            case OpCode::TAIL_CALL:
+                call_value(instruction.operand, true);
+                break;
+            case OpCode::EVAL_PAIR: {
+                std::shared_ptr<Object> rest = std::move(stack.back());
+                stack.pop_back();
+                std::shared_ptr<Object>& head = stack.back();
+                if (IsBuiltinCall(head)) {
+                    argument_collector.clear();
+                    CollectArguments(rest, &argument_collector);
+                    head = ApplyBuiltinFunction(View<Symbol>(head)->GetId(), argument_collector);
+                } else if (Is<Closure>(head)) {
+                    argument_collector.clear();
+                    CollectArguments(rest, &argument_collector);
+                    stack.insert(stack.end(), argument_collector.begin(),
+                                 argument_collector.end());
+                    call_value(argument_collector.size(), false);
+                } else {
+                    head = New<Cell>(head, rest);
+                }
+                break;
+            }
+            case OpCode::JUMP:
+                current->pc = instruction.operand;
+                break;
+            case OpCode::JUMP_IF_FALSE: {
+                bool condition = IsTruthy(DefinitePointer(stack.back()));
+                stack.pop_back();
+                if (!condition) {
+                    current->pc = instruction.operand;
+                }
+                break;
+            }
+            case OpCode::POP:
+                stack.pop_back();
+                break;
+            case OpCode::ENTER_FRAME: {
+                std::shared_ptr<Frame> frame = std::make_shared<Frame>();
+                frame->slots.assign(std::make_move_iterator(stack.end() - instruction.operand),
+                                    std::make_move_iterator(stack.end()));
+                for (std::shared_ptr<Object>& slot : frame->slots) {
+                    slot = DefinitePointer(slot);
+                }
+                frame->parent = std::move(current->environment);
+                stack.resize(stack.size() - instruction.operand);
+                current->environment = std::move(frame);
+                break;
+            }
+            case OpCode::LEAVE_FRAME: {
+                std::shared_ptr<Frame> parent = current->environment->parent;
+                current->environment = std::move(parent);
+                break;
+            }
+            case OpCode::RETURN:
+                calls.pop_back();
+                if (calls.empty()) {
+                    return stack.back();
+                }
+                current = &calls.back();
+                break;
+        }
+    }
+}
+
+std::shared_ptr<Object> Closure::Apply(SymbolId, Arguments args) {
+    Program trampoline;
+    trampoline.constants.push_back(shared_from_this());
+    trampoline.constants.insert(trampoline.constants.end(), args.begin(), args.end());
+    for (uint32_t i = 0; i < trampoline.constants.size(); ++i) {
+        trampoline.code.push_back({OpCode::PUSH_CONSTANT, 0, i});
+    }
+    trampoline.code.push_back({OpCode::CALL_VALUE, 0, static_cast<uint32_t>(args.size())});
+    trampoline.code.push_back({OpCode::RETURN});
+    trampoline.max_stack_size = trampoline.constants.size();
+    return Execute(trampoline, globals_);
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "object.h"
+#include "source_map.h"
+
+enum class OpCode : uint8_t {
+    PUSH_CONSTANT,  // push constants[operand]
+    LOAD_LOCAL,     // push slot `operand` of the frame `depth` levels up
+    LOAD_GLOBAL,    // push global `symbol`, or constants[operand] if it is not defined
+    DEFINE_GLOBAL,  // pop a value into global `symbol`, push constants[operand]
+    MAKE_CLOSURE,   // push a closure of functions[operand] over the current frame
+    CALL,           // apply builtin `symbol` to the top `operand` values
+    CALL_DEFINITE,  // CALL whose arguments are known not to be #t/#f symbols
+    CALL_VALUE,     // apply the value below the top `operand` values to them
+    TAIL_CALL,      // CALL_VALUE in tail position: a called closure replaces the current function
+    EVAL_PAIR,      // pop rest and head; apply head to rest if it is a procedure, else cons them
+    JUMP,           // continue at `operand`
+    JUMP_IF_FALSE,  // pop a value, continue at `operand` if it is #f
+    POP,            // drop the top value
+    ENTER_FRAME,    // pop `operand` values into a new frame nested in the current one
+    LEAVE_FRAME,    // return to the parent of the current frame
+    RETURN,         // leave the current function, its result is on top of the stack
+};
+
+struct Instruction {
+    OpCode code;
+    SymbolId symbol = 0;
+    uint32_t operand = 0;
+    uint32_t depth = 0;
+};
+
+// Compiled form of one expression or lambda body. It never refers back to the AST it was built
+// from except through quoted constants, which are only read, so a program can be executed any
+// number of times.
+struct Program {
+    std::vector<Instruction> code;
+    std::vector<std::shared_ptr<Object>> constants;
+    std::vector<std::shared_ptr<const Program>> functions;
+    uint32_t parameter_count = 0;
+    size_t max_stack_size = 0;
+    bool defines_globals = false;
+    // the innermost list each instruction was compiled from, parallel to code; only filled in
+    // when compiled with a source map, which is kept for the text of the spans
+    std::vector<SourceSpan> spans;
+    std::shared_ptr<const SourceMap> source_map;
+};
+
+// Variables introduced by one lambda call or let, addressed by position.
+struct Frame {
+    std::vector<std::shared_ptr<Object>> slots;
+    std::shared_ptr<Frame> parent;
+};
+
+// Top-level definitions of a session, indexed by symbol id.
+class GlobalEnvironment {
+public:
+    const std::shared_ptr<Object>* Find(SymbolId id) const {
+        if (id >= bound_.size() || !bound_[id]) {
+            return nullptr;
+        }
+        return &values_[id];
+    }
+
+    void Define(SymbolId id, std::shared_ptr<Object> value) {
+        if (id >= bound_.size()) {
+            bound_.resize(id + 1);
+            values_.resize(id + 1);
+        }
+        bound_[id] = true;
+        values_[id] = std::move(value);
+    }
+
+    // Calls f with every defined value, which f may replace.
+    template <class F>
+    void ForEachValue(F&& f) {
+        for (size_t id = 0; id < values_.size(); ++id) {
+            if (bound_[id]) {
+                f(values_[id]);
+            }
+        }
+    }
+
+private:
+    std::vector<std::shared_ptr<Object>> values_;
+    std::vector<bool> bound_;
+};
+
+class Closure : public Object {
+public:
+    static constexpr ObjectType kType = ObjectType::CLOSURE;
+
+    Closure(std::shared_ptr<const Program> program, std::shared_ptr<Frame> environment,
+            GlobalEnvironment* globals)
+        : Object(kType),
+          program_{std::move(program)},
+          environment_{std::move(environment)},
+          globals_{globals} {
+    }
+    virtual ~Closure() override = default;
+    virtual std::string ToString() override {
+        return "can't print a function\n";
+    }
+    virtual std::shared_ptr<Object> Apply(SymbolId, Arguments args) override;
+
+    const std::shared_ptr<const Program>& GetProgram() const {
+        return program_;
+    }
+    const std::shared_ptr<Frame>& GetEnvironment() const {
+        return environment_;
+    }
+    GlobalEnvironment* GetGlobals() const {
+        return globals_;
+    }
+
+private:
+    std::shared_ptr<const Program> program_;
+    std::shared_ptr<Frame> environment_;
+    GlobalEnvironment* globals_;
+};
+
+// With a source map of ast, the program and its functions know where their instructions come from.
+Program Compile(const std::shared_ptr<Object>& ast,
+                std::shared_ptr<const SourceMap> source_map = nullptr);
+std::shared_ptr<Object> Execute(const Program& program, GlobalEnvironment* globals);
@@ -0,0 +1,28 @@
+#include "deadline.h"
+
+#include "error.h"
+
+thread_local DeadlineScope* DeadlineScope::current_ = nullptr;
+
+DeadlineScope::DeadlineScope(std::optional<std::chrono::steady_clock::time_point> deadline) {
+    if (!deadline) {
+        return;
+    }
+    deadline_ = *deadline;
+    is_attached_ = true;
+    previous_ = current_;
+    current_ = this;
+}
+
+DeadlineScope::~DeadlineScope() {
+    if (is_attached_) {
+        current_ = previous_;
+    }
+}
+
+void DeadlineScope::CheckClock() {
+    countdown_ = kDeadlineCheckInterval;
+    if (std::chrono::steady_clock::now() >= deadline_) {
+        throw TimeoutError("evaluation timed out\n");
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+// safe points between two looks at the clock
+const uint32_t kDeadlineCheckInterval = 256;
+
+// Stops the evaluators running on the calling thread once a point in time has passed: the first
+// of their safe points after it throws TimeoutError. Without a deadline nothing is attached, and
+// evaluators don't look at the clock at all. A single builtin call is not interrupted, so a run
+// may overshoot by the length of one.
+class DeadlineScope {
+public:
+    explicit DeadlineScope(std::optional<std::chrono::steady_clock::time_point> deadline);
+    DeadlineScope(const DeadlineScope&) = delete;
+    DeadlineScope& operator=(const DeadlineScope&) = delete;
+    ~DeadlineScope();
+
+    static DeadlineScope* Current() {
+        return current_;
+    }
+
+    // Called at every safe point, reads the clock every kDeadlineCheckInterval calls.
+    void Check() {
+        if (!--countdown_) {
+            CheckClock();
+        }
+    }
+
+private:
+    void CheckClock();
+
+    std::chrono::steady_clock::time_point deadline_;
+    bool is_attached_ = false;
+    uint32_t countdown_ = kDeadlineCheckInterval;
+    DeadlineScope* previous_ = nullptr;
+
+    static thread_local DeadlineScope* current_;
+};
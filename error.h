@@ -13,3 +13,8 @@ struct RuntimeError : public std::runtime_error {
 struct NameError : public std::runtime_error {
     using std::runtime_error::runtime_error;
 };
+
+// Evaluation went past its time limit.
+struct TimeoutError : public RuntimeError {
+    using RuntimeError::RuntimeError;
+};
@@ -0,0 +1,188 @@
+#include <fold.h>
+
+#include <printer.h>
+
+#include <algorithm>
+
+namespace {
+
+// deeper subtrees are left as they are rather than folded on the native stack
+const size_t kMaxFoldDepth = 1000;
+
+// Builtins without side effects whose result depends on nothing but their arguments.
+const BuiltinTable<bool> foldable_functions = {
+    {PLUS, true}, {MINUS, true}, {MULTIPLY, true}, {MAX, true}, {MIN, true}, {ABS, true},
+    {EQUAL, true}, {LESS, true}, {GREATER, true}, {LESS_EQUAL, true}, {GREATER_EQUAL, true},
+    {CAR, true}, {CDR, true}};
+
+// Stores the value of an argument which evaluates to itself or is quoted.
+bool GetLiteralValue(const std::shared_ptr<Object>& argument, std::shared_ptr<Object>* value) {
+    if (IsQuoteForm(argument)) {
+        *value = DefinitePointer(QuotedDatum(argument));
+        return !IsBuiltinCall(*value);
+    }
+    *value = DefinitePointer(argument);
+    return Is<Number>(*value) || Is<Boolean>(*value);
+}
+
+// Whether applying function to arguments gives a value rather than an error. A call in a lambda
+// or in a branch may never be evaluated at all, so folding must not fail on any of them.
+bool CanApply(SymbolId function, const std::vector<std::shared_ptr<Object>>& arguments) {
+    if (function == CAR || function == CDR) {
+        return arguments.size() == 1 && Is<Cell>(arguments[0]);
+    }
+    if (arguments.empty() || (function == ABS && arguments.size() != 1)) {
+        return false;
+    }
+    return std::all_of(arguments.begin(), arguments.end(), [](const std::shared_ptr<Object>& x) {
+        return Is<Number>(x);
+    });
+}
+
+// An expression which evaluates to value.
+std::shared_ptr<Object> MakeLiteral(const std::shared_ptr<Object>& value) {
+    if (Is<Number>(value) || Is<Boolean>(value)) {
+        return value;
+    }
+    return New<Cell>(New<Symbol>(QUOTE), New<Cell>(value));
+}
+
+// Whether argument may evaluate to something a list is applied as when it heads one: a builtin
+// or a closure.
+bool MayYieldProcedure(const std::shared_ptr<Object>& argument) {
+    if (Is<Symbol>(argument)) {
+        return true;
+    }
+    Cell* cell = View<Cell>(argument);
+    if (!cell || IsQuoteForm(argument)) {
+        return false;
+    }
+    return !IsBuiltinCall(cell->GetFirst()) ||
+           ReturnsArgument(View<Symbol>(cell->GetFirst())->GetId());
+}
+
+// Whether each argument of (head arguments...) is evaluated as an expression of its own. When
+// an argument may yield a builtin, Compile evaluates the tails of the argument list as
+// expressions too, and a tail headed by a symbol or a lambda is taken for a call.
+bool AreArgumentsExpressions(const Cell& form) {
+    if (!IsProperList(form.GetSecond())) {
+        return false;
+    }
+    bool may_yield_procedure = false;
+    bool may_yield_builtin = !IsBuiltinCall(form.GetFirst());
+    for (std::shared_ptr<Object> jumper = form.GetSecond(); jumper;
+         jumper = View<Cell>(jumper)->GetSecond()) {
+        std::shared_ptr<Object> argument = View<Cell>(jumper)->GetFirst();
+        may_yield_procedure = may_yield_procedure || MayYieldProcedure(DefinitePointer(argument));
+        may_yield_builtin = may_yield_builtin || MayYieldBuiltin(argument);
+    }
+    return !may_yield_procedure || !may_yield_builtin;
+}
+
+std::shared_ptr<Object> FoldExpression(const std::shared_ptr<Object>& expression, size_t depth,
+                                       FoldReport* report);
+
+// Folds the elements of a proper list in place. Calc takes a tail of the list which looks like
+// (quote datum) for a quote form, so the elements from there on are data.
+void FoldElements(const std::shared_ptr<Object>& list, size_t depth, FoldReport* report) {
+    for (std::shared_ptr<Object> jumper = list; jumper && !IsQuoteForm(jumper);
+         jumper = View<Cell>(jumper)->GetSecond()) {
+        Cell* cell = View<Cell>(jumper);
+        cell->SetFirst(FoldExpression(cell->GetFirst(), depth, report));
+    }
+}
+
+// Only the parts evaluated as expressions are folded: the operands of if, the values of define
+// and let, and the bodies. Malformed forms are left for Compile to reject.
+void FoldSpecialForm(SymbolId form, const Cell& cell, size_t depth, FoldReport* report) {
+    Cell* operands = View<Cell>(cell.GetSecond());
+    if (!operands || !IsProperList(cell.GetSecond()) || IsQuoteForm(cell.GetSecond())) {
+        return;
+    }
+    // everything after the first operand
+    std::shared_ptr<Object> body = operands->GetSecond();
+    if (form == IF) {
+        FoldElements(cell.GetSecond(), depth, report);
+        return;
+    }
+    if (form == LET && IsProperList(operands->GetFirst())) {
+        for (std::shared_ptr<Object> jumper = operands->GetFirst(); jumper && !IsQuoteForm(jumper);
+             jumper = View<Cell>(jumper)->GetSecond()) {
+            std::shared_ptr<Object> element = View<Cell>(jumper)->GetFirst();
+            Cell* binding = View<Cell>(element);
+            if (binding && !IsQuoteForm(element) && Is<Cell>(binding->GetSecond()) &&
+                !View<Cell>(binding->GetSecond())->GetSecond()) {
+                FoldElements(binding->GetSecond(), depth, report);
+            }
+        }
+    }
+    FoldElements(body, depth, report);
+}
+
+// (function arguments...) with folded arguments: its value if they are all literals and
+// applying function to them succeeds.
+std::shared_ptr<Object> FoldCall(SymbolId function, const std::shared_ptr<Object>& call,
+                                 FoldReport* report) {
+    if (!foldable_functions[function]) {
+        return call;
+    }
+    std::vector<std::shared_ptr<Object>> arguments;
+    for (std::shared_ptr<Object> jumper = View<Cell>(call)->GetSecond(); jumper;
+         jumper = View<Cell>(jumper)->GetSecond()) {
+        std::shared_ptr<Object> value;
+        if (!GetLiteralValue(View<Cell>(jumper)->GetFirst(), &value)) {
+            return call;
+        }
+        arguments.push_back(std::move(value));
+    }
+    // a failing call is left to throw when evaluation gets to it
+    if (!CanApply(function, arguments)) {
+        return call;
+    }
+    std::shared_ptr<Object> result = ApplyBuiltinFunction(function, arguments);
+    // the enclosing list would become a call of it
+    if (IsBuiltinCall(result)) {
+        return call;
+    }
+    if (report) {
+        report->folds.push_back(Print(call) + " => " + Print(result));
+    }
+    return MakeLiteral(result);
+}
+
+std::shared_ptr<Object> FoldExpression(const std::shared_ptr<Object>& expression, size_t depth,
+                                       FoldReport* report) {
+    Cell* cell = View<Cell>(expression);
+    if (!cell || IsQuoteForm(expression) || depth == kMaxFoldDepth) {
+        return expression;
+    }
+    ++depth;
+    std::shared_ptr<Object> head = cell->GetFirst();
+    if (Is<Cell>(head)) {
+        cell->SetFirst(FoldExpression(head, depth, report));
+        if (AreArgumentsExpressions(*cell)) {
+            FoldElements(cell->GetSecond(), depth, report);
+        }
+        return expression;
+    }
+    Symbol* symbol = View<Symbol>(head);
+    if (!symbol) {
+        return expression;
+    }
+    SymbolId id = symbol->GetId();
+    if (IsSpecialForm(id)) {
+        FoldSpecialForm(id, *cell, depth, report);
+    } else if (IsVariableName(id) && IsProperList(cell->GetSecond())) {
+        FoldElements(cell->GetSecond(), depth, report);
+    } else if (IsBuiltinFunction(id) && AreArgumentsExpressions(*cell)) {
+        FoldElements(cell->GetSecond(), depth, report);
+        return FoldCall(id, expression, report);
+    }
+    return expression;
+}
+
+}  // namespace
+
+std::shared_ptr<Object> Fold(const std::shared_ptr<Object>& ast, FoldReport* report) {
+    return FoldExpression(ast, 0, report);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "object.h"
+
+// What one Fold call did, e.g. "(+ 1 2) => 3" for every call it replaced.
+struct FoldReport {
+    std::vector<std::string> folds;
+};
+
+// Replaces calls of pure builtins (+ - * max min abs, comparisons, car and cdr) whose arguments
+// are all literals by their values, innermost first. Only places both Calc and Compile evaluate
+// as expressions are touched, and a call which would fail is left for the evaluator to report, so
+// the result of the folded tree is the same as the one of `ast`. The tree is changed in place.
+std::shared_ptr<Object> Fold(const std::shared_ptr<Object>& ast, FoldReport* report);
@@ -0,0 +1,120 @@
+#include <gc.h>
+
+std::shared_ptr<Object> Relocator::Copy(const std::shared_ptr<Object>& object) {
+    // objects without a control block are the immortal ones
+    if (!object || object.use_count() == 0) {
+        return object;
+    }
+    auto it = objects_.find(object.get());
+    if (it != objects_.end()) {
+        return it->second;
+    }
+    std::shared_ptr<Object> copy;
+    switch (object->GetType()) {
+        case ObjectType::CELL:
+            return CopyRun(object);
+        case ObjectType::NUMBER:
+            copy = New<Number>(*View<Number>(object));
+            break;
+        case ObjectType::SYMBOL:
+            copy = New<Symbol>(*View<Symbol>(object));
+            break;
+        case ObjectType::DOT:
+            copy = New<Dot>();
+            break;
+        case ObjectType::NUMERIC_VECTOR:
+            copy = New<NumericVector>(*View<NumericVector>(object));
+            break;
+        case ObjectType::BOOLEAN:
+            copy = MakeBoolean(View<Boolean>(object)->Get());
+            break;
+        case ObjectType::CLOSURE: {
+            Closure* closure = View<Closure>(object);
+            copy = New<Closure>(CopyProgram(closure->GetProgram()),
+                                CopyFrame(closure->GetEnvironment()), closure->GetGlobals());
+            break;
+        }
+        default:
+            // builtin functions are allocated once, outside of any arena
+            return object;
+    }
+    objects_.emplace(object.get(), copy);
+    return copy;
+}
+
+// The cells of a run are copied into a run of their own, up to one which has been copied already,
+// so a list built by MakeList keeps its layout.
+std::shared_ptr<Object> Relocator::CopyRun(const std::shared_ptr<Object>& cell) {
+    std::vector<std::shared_ptr<Object>> originals = {cell};
+    size_t run_length = View<Cell>(cell)->GetRunLength();
+    while (originals.size() <= run_length) {
+        std::shared_ptr<Object> next = View<Cell>(originals.back())->GetSecond();
+        if (objects_.contains(next.get())) {
+            break;
+        }
+        originals.push_back(std::move(next));
+    }
+    // the fields are filled in by Finish, like those of any other cell
+    std::shared_ptr<Object> copy = MakeList(std::vector<std::shared_ptr<Object>>(originals.size()));
+    std::shared_ptr<Object> copied_cell = copy;
+    for (const std::shared_ptr<Object>& original : originals) {
+        objects_.emplace(original.get(), copied_cell);
+        pending_cells_.emplace_back(original, View<Cell>(copied_cell));
+        copied_cell = View<Cell>(copied_cell)->GetSecond();
+    }
+    return copy;
+}
+
+std::shared_ptr<const Program> Relocator::CopyProgram(
+    const std::shared_ptr<const Program>& program) {
+    auto it = programs_.find(program.get());
+    if (it != programs_.end()) {
+        return it->second;
+    }
+    std::shared_ptr<Program> copy = std::make_shared<Program>(*program);
+    programs_.emplace(program.get(), copy);
+    pending_programs_.push_back(copy.get());
+    return copy;
+}
+
+std::shared_ptr<Frame> Relocator::CopyFrame(const std::shared_ptr<Frame>& frame) {
+    if (!frame) {
+        return nullptr;
+    }
+    auto it = frames_.find(frame.get());
+    if (it != frames_.end()) {
+        return it->second;
+    }
+    std::shared_ptr<Frame> copy = std::make_shared<Frame>(*frame);
+    frames_.emplace(frame.get(), copy);
+    pending_frames_.push_back(copy.get());
+    return copy;
+}
+
+void Relocator::Finish() {
+    while (!pending_cells_.empty() || !pending_programs_.empty() || !pending_frames_.empty()) {
+        if (!pending_cells_.empty()) {
+            auto [original, copy] = std::move(pending_cells_.back());
+            pending_cells_.pop_back();
+            Cell* cell = View<Cell>(original);
+            copy->SetFirst(Copy(cell->GetFirst()));
+            copy->SetSecond(Copy(cell->GetSecond()));
+        } else if (!pending_programs_.empty()) {
+            Program* program = pending_programs_.back();
+            pending_programs_.pop_back();
+            for (std::shared_ptr<Object>& constant : program->constants) {
+                constant = Copy(constant);
+            }
+            for (std::shared_ptr<const Program>& function : program->functions) {
+                function = CopyProgram(function);
+            }
+        } else {
+            Frame* frame = pending_frames_.back();
+            pending_frames_.pop_back();
+            for (std::shared_ptr<Object>& slot : frame->slots) {
+                slot = Copy(slot);
+            }
+            frame->parent = CopyFrame(frame->parent);
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bytecode.h"
+
+// Counters of the collector of one interpreter.
+struct GcStats {
+    size_t collections = 0;
+    size_t heap_bytes = 0;            // arena bytes holding session data
+    size_t last_live_bytes = 0;       // what the last collection kept
+    size_t last_reclaimed_bytes = 0;  // what the last collection gave back
+    size_t last_copied_objects = 0;
+    std::chrono::nanoseconds last_pause{0};
+    std::chrono::nanoseconds max_pause{0};
+    std::chrono::nanoseconds total_pause{0};
+};
+
+// Copies everything reachable from some roots into the current arena. Sharing between nodes is
+// kept, and nodes are visited through a work list, so neither cycles nor the depth of the data
+// are a problem. Immortal objects and builtin functions live outside arenas and are not copied.
+class Relocator {
+public:
+    // The copy is complete only after Finish.
+    std::shared_ptr<Object> Copy(const std::shared_ptr<Object>& object);
+    void Finish();
+
+    size_t GetCopiedObjects() const {
+        return objects_.size();
+    }
+
+private:
+    std::shared_ptr<Object> CopyRun(const std::shared_ptr<Object>& cell);
+    std::shared_ptr<const Program> CopyProgram(const std::shared_ptr<const Program>& program);
+    std::shared_ptr<Frame> CopyFrame(const std::shared_ptr<Frame>& frame);
+
+    std::unordered_map<const Object*, std::shared_ptr<Object>> objects_;
+    std::unordered_map<const Program*, std::shared_ptr<Program>> programs_;
+    std::unordered_map<const Frame*, std::shared_ptr<Frame>> frames_;
+    // copies whose fields still refer to the originals, next to their originals
+    std::vector<std::pair<std::shared_ptr<Object>, Cell*>> pending_cells_;
+    std::vector<Program*> pending_programs_;
+    std::vector<Frame*> pending_frames_;
+};
@@ -1,255 +1,762 @@
-#include "object.h"
-
-std::set<std::string> incorrect_empty_functions = {"-", "/", "max", "min", "not"};
-std::map<std::string, int64_t> empty_integer_functions = {{"+", 0}, {"*", 1}};
-std::map<std::string, bool> empty_bool_functions = {{"and", true}, {"or", false}};
-
-std::map<std::string, std::function<std::shared_ptr<Object>(
-                          std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>>)>>
-    construct_functions = {{"cons",
-                            [](std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>> object) {
-                                As<Cell>(object.first)->SetSecond(object.second);
-                                return object.first;
-                            }},
-                           {"list",
-                            [](std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>> object) {
-                                std::shared_ptr<Object> result =
-                                    std::make_shared<Cell>(As<Cell>(object.first)->GetFirst(),
-                                                           As<Cell>(object.first)->GetSecond());
-                                std::shared_ptr<Object> jumper = As<Cell>(result)->GetSecond();
-                                if (!jumper) {
-                                    As<Cell>(result)->SetSecond(
-                                        std::make_shared<Cell>(object.second));
-                                    return result;
-                                }
-                                while (Is<Cell>(jumper)) {
-                                    if (!As<Cell>(jumper)->GetSecond()) {
-                                        break;
-                                    }
-                                    if (Is<Cell>(As<Cell>(jumper)->GetSecond())) {
-                                        jumper = As<Cell>(jumper)->GetSecond();
-                                        continue;
-                                    }
-                                }
-                                As<Cell>(jumper)->SetSecond(std::make_shared<Cell>(object.second));
-                                return result;
-                            }}};
-
-std::map<std::string, std::function<std::shared_ptr<Object>(std::shared_ptr<Object>)>>
-    getter_functions = {
-        {"car", [](std::shared_ptr<Object> object) { return As<Cell>(object)->GetFirst(); }},
-        {"cdr", [](std::shared_ptr<Object> object) { return As<Cell>(object)->GetSecond(); }}};
-
-std::map<std::string, std::function<std::shared_ptr<Object>(
-                          std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>>)>>
-    getter_argument_functions = {{"list-ref",
-                                  [](std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>>
-                                         object) {
-                                      std::shared_ptr<Object> list = object.first;
-                                      while (!(Is<Number>(As<Cell>(list)->GetFirst()) &&
-                                               As<Number>(As<Cell>(list)->GetFirst())->GetValue() ==
-                                                   As<Number>(object.second)->GetValue())) {
-                                          if (!As<Cell>(list)->GetSecond()) {
-                                              throw RuntimeError("list has not this element\n");
-                                          }
-                                          list = As<Cell>(list)->GetSecond();
-                                      }
-                                      if (!As<Cell>(list)->GetSecond()) {
-                                          throw RuntimeError("list has not this element\n");
-                                      }
-                                      if (Is<Cell>(As<Cell>(list)->GetSecond())) {
-                                          return As<Cell>(As<Cell>(list)->GetSecond())->GetFirst();
-                                      }
-                                      return As<Cell>(list)->GetSecond();
-                                  }},
-                                 {"list-tail",
-                                  [](std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>>
-                                         object) {
-                                      std::shared_ptr<Object> list = object.first;
-                                      for (int64_t i = 0; i < As<Number>(object.second)->GetValue();
-                                           ++i) {
-                                          if (!Is<Cell>(list)) {
-                                              throw RuntimeError("tail is not exist\n");
-                                          }
-                                          list = As<Cell>(list)->GetSecond();
-                                      }
-                                      return list;
-                                  }}};
-
-std::map<std::string, std::function<bool(std::shared_ptr<Object>)>> unary_bool_functions = {
-    {"number?", [](std::shared_ptr<Object> object) { return Is<Number>(object); }},
-    {"boolean?", [](std::shared_ptr<Object> object) { return Is<Boolean>(object); }},
-    {"not",
-     [](std::shared_ptr<Object>(object)) {
-         if (Is<Boolean>(object)) {
-             return !As<Boolean>(object)->Get();
-         }
-         return false;
-     }},
-    {"pair?",
-     [](std::shared_ptr<Object> object) {
-         if (!Is<Cell>(object)) {
-             return false;
-         }
-         return !Is<Cell>(As<Cell>(object)->GetSecond()) ||
-                !As<Cell>(As<Cell>(object)->GetSecond())->GetSecond();
-     }},
-    {"null?", [](std::shared_ptr<Object> object) { return !object; }},
-    {"list?", [](std::shared_ptr<Object> object) {
-         if (!object) {
-             return true;
-         }
-         if (!Is<Cell>(object)) {
-             return false;
-         }
-         std::shared_ptr<Object> jumper = As<Cell>(object)->GetSecond();
-         while (Is<Cell>(jumper)) {
-             jumper = As<Cell>(jumper)->GetSecond();
-         }
-         return !jumper;
-     }}};
-
-std::map<std::string, std::function<int64_t(std::shared_ptr<Object>)>> unary_integer_functions = {
-    {"abs", [](std::shared_ptr<Object> object) { return abs(As<Number>(object)->GetValue()); }}};
-
-std::map<std::string,
-         std::function<bool(std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>>)>>
-    binary_bool_function = {
-        {"=",
-         [](std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>> object) {
-             return (As<Number>(object.first)->GetValue() == As<Number>(object.second)->GetValue());
-         }},
-        {"<",
-         [](std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>> object) {
-             return (As<Number>(object.first)->GetValue() < As<Number>(object.second)->GetValue());
-         }},
-        {">",
-         [](std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>> object) {
-             return (As<Number>(object.first)->GetValue() > As<Number>(object.second)->GetValue());
-         }},
-        {"<=",
-         [](std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>> object) {
-             return (As<Number>(object.first)->GetValue() <= As<Number>(object.second)->GetValue());
-         }},
-        {">=",
-         [](std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>> object) {
-             return (As<Number>(object.first)->GetValue() >= As<Number>(object.second)->GetValue());
-         }},
-};
-
-std::map<std::string, std::function<std::shared_ptr<Object>(
-                          std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>>)>>
-    or_and_function = {{"and",
-                        [](std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>> object) {
-                            std::shared_ptr<Boolean> first_argument =
-                                std::make_shared<Boolean>(object.first);
-                            std::shared_ptr<Boolean> second_argument =
-                                std::make_shared<Boolean>(object.second);
-                            if (first_argument->Get() && second_argument->Get()) {
-                                return object.second;
-                            }
-                            return As<Object>(std::make_shared<Boolean>(false));
-                        }},
-                       {"or",
-                        [](std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>> object) {
-                            std::shared_ptr<Boolean> first_argument =
-                                std::make_shared<Boolean>(object.first);
-                            std::shared_ptr<Boolean> second_argument =
-                                std::make_shared<Boolean>(object.second);
-                            if (first_argument->Get() || second_argument->Get()) {
-                                return object.second;
-                            }
-                            return As<Object>(std::make_shared<Boolean>(false));
-                        }}};
-
-std::map<std::string,
-         std::function<int64_t(std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>>)>>
-    binary_integer_function = {{"+",
-                                [](std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>>
-                                       object) {
-                                    return As<Number>(object.first)->GetValue() +
-                                           As<Number>(object.second)->GetValue();
-                                }},
-                               {"-",
-                                [](std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>>
-                                       object) {
-                                    return As<Number>(object.first)->GetValue() -
-                                           As<Number>(object.second)->GetValue();
-                                }},
-                               {"*",
-                                [](std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>>
-                                       object) {
-                                    return As<Number>(object.first)->GetValue() *
-                                           As<Number>(object.second)->GetValue();
-                                }},
-                               {"/",
-                                [](std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>>
-                                       object) {
-                                    return As<Number>(object.first)->GetValue() /
-                                           As<Number>(object.second)->GetValue();
-                                }},
-                               {"max",
-                                [](std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>>
-                                       object) {
-                                    return std::max(As<Number>(object.first)->GetValue(),
-                                                    As<Number>(object.second)->GetValue());
-                                }},
-                               {"min",
-                                [](std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>>
-                                       object) {
-                                    return std::min(As<Number>(object.first)->GetValue(),
-                                                    As<Number>(object.second)->GetValue());
-                                }}};
-
-int64_t ApplyEmptyIntegerFunction(const std::string& function) {
-    if (incorrect_empty_functions.find(function) != incorrect_empty_functions.end()) {
-        throw RuntimeError("function can't be apply to empty list arguments\n");
-    }
-    return empty_integer_functions[function];
-}
-
-bool ApplyEmptyBoolMutableFunction(const std::string& function) {
-    return empty_bool_functions[function];
-}
-
-bool ApplyUnaryBoolFunction(const std::string& function, const std::shared_ptr<Object> object) {
-    return unary_bool_functions[function](object);
-}
-
-bool ApplyBinaryBoolFunction(const std::string& function, const std::shared_ptr<Object> lhs,
-                             const std::shared_ptr<Object> rhs) {
-    return binary_bool_function[function](std::make_pair(lhs, rhs));
-}
-
-int64_t ApplyBinaryIntegerFunction(const std::string& function, const std::shared_ptr<Object> lhs,
-                                   const std::shared_ptr<Object> rhs) {
-    return binary_integer_function[function](std::make_pair(lhs, rhs));
-}
-
-int64_t ApplyUnaryIntegerFunction(const std::string& function,
-                                  const std::shared_ptr<Object> object) {
-    return unary_integer_functions[function](object);
-}
-
-std::shared_ptr<Object> ApplyMutableBoolFunction(const std::string& function,
-                                                 const std::shared_ptr<Object> lhs,
-                                                 const std::shared_ptr<Object> rhs) {
-    return or_and_function[function](std::make_pair(lhs, rhs));
-}
-
-std::shared_ptr<Object> ApplyConstructorFunction(const std::string& function,
-                                                 const std::shared_ptr<Object> lhs,
-                                                 const std::shared_ptr<Object> rhs) {
-    return construct_functions[function](std::make_pair(lhs, rhs));
-}
-
-std::shared_ptr<Object> ApplyGetterFunction(const std::string& function,
-                                            const std::shared_ptr<Object> object) {
-    return getter_functions[function](object);
-}
-
-std::shared_ptr<Object> ApplyGetterArgumentFunction(const std::string& function,
-                                                    const std::shared_ptr<Object> lhs,
-                                                    const std::shared_ptr<Object> rhs) {
-    return getter_argument_functions[function](std::make_pair(lhs, rhs));
-}
\ No newline at end of file
+#include "object.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "printer.h"
+#include "vector_kernels.h"
+
+const int64_t kMinCachedNumber = -128;
+const int64_t kMaxCachedNumber = 1023;
+
+namespace {
+
+template <class T>
+std::shared_ptr<T> Immortal(T* object) {
+    // aliasing constructor with an empty owner: no control block, nothing to count
+    return std::shared_ptr<T>(std::shared_ptr<T>(), object);
+}
+
+}  // namespace
+
+std::shared_ptr<Boolean> MakeBoolean(bool value) {
+    static Boolean true_object(true);
+    static Boolean false_object(false);
+    return Immortal(value ? &true_object : &false_object);
+}
+
+std::shared_ptr<Number> MakeNumber(int64_t value) {
+    static std::vector<Number> cache = [] {
+        std::vector<Number> numbers;
+        numbers.reserve(kMaxCachedNumber - kMinCachedNumber + 1);
+        for (int64_t i = kMinCachedNumber; i <= kMaxCachedNumber; ++i) {
+            numbers.emplace_back(i);
+        }
+        return numbers;
+    }();
+    if (kMinCachedNumber <= value && value <= kMaxCachedNumber) {
+        return Immortal(&cache[value - kMinCachedNumber]);
+    }
+    return New<Number>(value);
+}
+
+std::shared_ptr<Number> MakeNumber(BigInteger value) {
+    if (value.FitsInt64()) {
+        return MakeNumber(value.ToInt64());
+    }
+    return New<Number>(std::move(value));
+}
+
+std::shared_ptr<Nullptr> MakeNullptr() {
+    static Nullptr nullptr_object;
+    return Immortal(&nullptr_object);
+}
+
+bool IsTruthy(const std::shared_ptr<Object>& object) {
+    Boolean* boolean = View<Boolean>(object);
+    return !boolean || boolean->Get();
+}
+
+using ObjectPair = std::pair<std::shared_ptr<Object>, std::shared_ptr<Object>>;
+
+namespace {
+
+const Cell* PairArgument(const std::shared_ptr<Object>& object) {
+    const Cell* cell = View<Cell>(object);
+    if (!cell) {
+        throw RuntimeError("arguments are belong to different types\n");
+    }
+    return cell;
+}
+
+}  // namespace
+
+const BuiltinTable<bool> incorrect_empty_functions = {
+    {MINUS, true}, {DIVIDE, true}, {MAX, true}, {MIN, true}, {NOT, true}};
+const BuiltinTable<int64_t> empty_integer_functions = {{PLUS, 0}, {MULTIPLY, 1}};
+const BuiltinTable<bool> empty_bool_functions = {{AND, true}, {OR, false}};
+
+const BuiltinTable<std::function<std::shared_ptr<Object>(Arguments)>> construct_functions = {
+    {CONS,
+     [](Arguments args) {
+         // the last of the arguments after the first one is the second
+         return As<Object>(New<Cell>(args.front(), args.size() > 1 ? args.back() : nullptr));
+     }},
+    {LIST, [](Arguments args) { return MakeList(args); }}};
+
+const BuiltinTable<std::function<std::shared_ptr<Object>(const std::shared_ptr<Object>&)>>
+    getter_functions = {
+        {CAR,
+         [](const std::shared_ptr<Object>& object) { return PairArgument(object)->GetFirst(); }},
+        {CDR,
+         [](const std::shared_ptr<Object>& object) { return PairArgument(object)->GetSecond(); }}};
+
+const BuiltinTable<std::function<std::shared_ptr<Object>(const ObjectPair&)>>
+    getter_argument_functions = {{LIST_REF,
+                                  [](const ObjectPair& object) {
+                                      const Cell* list = View<Cell>(object.first);
+                                      const Number* index = View<Number>(object.second);
+                                      if (!list || !index) {
+                                          throw RuntimeError(
+                                              "arguments are belong to different types\n");
+                                      }
+                                      if (!index->IsFixnum() || index->IsNegative() ||
+                                          !(list = list->Skip(index->GetValue()))) {
+                                          throw RuntimeError("list has not this element\n");
+                                      }
+                                      return list->GetFirst();
+                                  }},
+                                 {LIST_TAIL,
+                                  [](const ObjectPair& object) {
+                                      const Number* count = View<Number>(object.second);
+                                      if (!count) {
+                                          throw RuntimeError(
+                                              "arguments are belong to different types\n");
+                                      }
+                                      if (count->IsNegative() ||
+                                          (count->IsFixnum() && count->GetValue() == 0)) {
+                                          return object.first;
+                                      }
+                                      // the cell before the tail holds a reference to it, and a
+                                      // positive bignum runs past the end of any list
+                                      const Cell* list = View<Cell>(object.first);
+                                      if (list && count->IsFixnum()) {
+                                          list = list->Skip(count->GetValue() - 1);
+                                      }
+                                      if (!list || !count->IsFixnum()) {
+                                          throw RuntimeError("tail is not exist\n");
+                                      }
+                                      return list->GetSecond();
+                                  }}};
+
+const BuiltinTable<std::function<bool(const std::shared_ptr<Object>&)>> unary_bool_functions = {
+    {IS_NUMBER, [](const std::shared_ptr<Object>& object) { return Is<Number>(object); }},
+    {IS_BOOLEAN, [](const std::shared_ptr<Object>& object) { return Is<Boolean>(object); }},
+    {IS_VECTOR, [](const std::shared_ptr<Object>& object) { return Is<NumericVector>(object); }},
+    {NOT,
+     [](const std::shared_ptr<Object>& object) {
+         if (Is<Boolean>(object)) {
+             return !View<Boolean>(object)->Get();
+         }
+         return false;
+     }},
+    {IS_PAIR,
+     [](const std::shared_ptr<Object>& object) {
+         if (!Is<Cell>(object)) {
+             return false;
+         }
+         return !Is<Cell>(View<Cell>(object)->GetSecond()) ||
+                !View<Cell>(View<Cell>(object)->GetSecond())->GetSecond();
+     }},
+    {IS_NULL, [](const std::shared_ptr<Object>& object) { return !object; }},
+    {IS_LIST, [](const std::shared_ptr<Object>& object) { return IsProperList(object); }}};
+
+const BuiltinTable<std::function<std::shared_ptr<Number>(const Number&)>>
+    unary_integer_functions = {{ABS, [](const Number& number) {
+                                    // the magnitude of INT64_MIN is out of range
+                                    if (number.IsFixnum() && number.GetValue() != INT64_MIN) {
+                                        return MakeNumber(std::abs(number.GetValue()));
+                                    }
+                                    return MakeNumber(number.ToBigInteger().Abs());
+                                }}};
+
+const BuiltinTable<std::function<bool(int64_t, int64_t)>> binary_bool_function = {
+    {EQUAL, [](int64_t lhs, int64_t rhs) { return lhs == rhs; }},
+    {LESS, [](int64_t lhs, int64_t rhs) { return lhs < rhs; }},
+    {GREATER, [](int64_t lhs, int64_t rhs) { return lhs > rhs; }},
+    {LESS_EQUAL, [](int64_t lhs, int64_t rhs) { return lhs <= rhs; }},
+    {GREATER_EQUAL, [](int64_t lhs, int64_t rhs) { return lhs >= rhs; }},
+};
+
+const BuiltinTable<std::function<std::shared_ptr<Object>(const ObjectPair&)>>
+    or_and_function = {{AND,
+                        [](const ObjectPair& object) {
+                            if (IsTruthy(object.first) && IsTruthy(object.second)) {
+                                return object.second;
+                            }
+                            return As<Object>(MakeBoolean(false));
+                        }},
+                       {OR,
+                        [](const ObjectPair& object) {
+                            if (IsTruthy(object.first) || IsTruthy(object.second)) {
+                                return object.second;
+                            }
+                            return As<Object>(MakeBoolean(false));
+                        }}};
+
+namespace {
+
+// Fixnum arithmetic: false, with *result unspecified, when the result doesn't fit in an int64_t.
+// A switch rather than a table of std::function, so that the loop over the arguments compiles to
+// the bare instruction and its overflow flag.
+inline bool ApplyFixnumFunction(SymbolId function, int64_t lhs, int64_t rhs, int64_t* result) {
+    switch (function) {
+        case PLUS:
+            return !__builtin_add_overflow(lhs, rhs, result);
+        case MINUS:
+            return !__builtin_sub_overflow(lhs, rhs, result);
+        case MULTIPLY:
+            return !__builtin_mul_overflow(lhs, rhs, result);
+        case DIVIDE:
+            if (rhs == 0) {
+                throw RuntimeError("division by zero\n");
+            }
+            // INT64_MIN / -1 is the one quotient out of range
+            if (rhs == -1) {
+                return !__builtin_sub_overflow(0, lhs, result);
+            }
+            *result = lhs / rhs;
+            return true;
+        case MAX:
+            *result = std::max(lhs, rhs);
+            return true;
+        default:
+            *result = std::min(lhs, rhs);
+            return true;
+    }
+}
+
+const Number* NumberArgument(const std::shared_ptr<Object>& argument) {
+    const Number* number = View<Number>(argument);
+    if (!number) {
+        throw RuntimeError("arguments are belong to different types\n");
+    }
+    return number;
+}
+
+}  // namespace
+
+const BuiltinTable<std::function<BigInteger(const BigInteger&, const BigInteger&)>>
+    big_integer_function = {
+        {PLUS, [](const BigInteger& lhs, const BigInteger& rhs) { return lhs + rhs; }},
+        {MINUS, [](const BigInteger& lhs, const BigInteger& rhs) { return lhs - rhs; }},
+        {MULTIPLY, [](const BigInteger& lhs, const BigInteger& rhs) { return lhs * rhs; }},
+        {DIVIDE,
+         [](const BigInteger& lhs, const BigInteger& rhs) {
+             if (rhs.IsZero()) {
+                 throw RuntimeError("division by zero\n");
+             }
+             return lhs / rhs;
+         }},
+        {MAX,
+         [](const BigInteger& lhs, const BigInteger& rhs) {
+             return Compare(lhs, rhs) < 0 ? rhs : lhs;
+         }},
+        {MIN, [](const BigInteger& lhs, const BigInteger& rhs) {
+             return Compare(lhs, rhs) > 0 ? rhs : lhs;
+         }}};
+
+int64_t ApplyEmptyIntegerFunction(SymbolId function) {
+    if (incorrect_empty_functions[function]) {
+        throw RuntimeError("function can't be apply to empty list arguments\n");
+    }
+    return empty_integer_functions[function];
+}
+
+bool ApplyEmptyBoolMutableFunction(SymbolId function) {
+    return empty_bool_functions[function];
+}
+
+bool ApplyUnaryBoolFunction(SymbolId function, const std::shared_ptr<Object>& object) {
+    return unary_bool_functions[function](object);
+}
+
+bool ApplyBinaryBoolFunction(SymbolId function, const Number& lhs, const Number& rhs) {
+    if (lhs.IsFixnum() && rhs.IsFixnum()) {
+        return binary_bool_function[function](lhs.GetValue(), rhs.GetValue());
+    }
+    // lhs is ordered against rhs the way their comparison is against zero
+    return binary_bool_function[function](Compare(lhs.ToBigInteger(), rhs.ToBigInteger()), 0);
+}
+
+std::shared_ptr<Object> ApplyBinaryIntegerFunction(SymbolId function, Arguments numbers) {
+    const Number* first = View<Number>(numbers[0]);
+    if (!first) {
+        return ApplyVectorArithmetic(function, numbers);
+    }
+    int64_t fixnum = first->GetValue();
+    size_t i = 1;
+    if (first->IsFixnum()) {
+        for (; i < numbers.size(); ++i) {
+            const Number* next = View<Number>(numbers[i]);
+            int64_t result;
+            if (!next || !next->IsFixnum() ||
+                !ApplyFixnumFunction(function, fixnum, next->GetValue(), &result)) {
+                break;
+            }
+            fixnum = result;
+        }
+        if (i == numbers.size()) {
+            return MakeNumber(fixnum);
+        }
+    }
+    // from the first bignum or overflow on, dropping back to fixnums once a result fits again
+    bool is_big = !first->IsFixnum();
+    BigInteger big = is_big ? first->ToBigInteger() : BigInteger();
+    for (; i < numbers.size(); ++i) {
+        const Number* next = View<Number>(numbers[i]);
+        if (!next) {
+            return ApplyVectorArithmetic(function, numbers);
+        }
+        int64_t result;
+        if (!is_big && next->IsFixnum() &&
+            ApplyFixnumFunction(function, fixnum, next->GetValue(), &result)) {
+            fixnum = result;
+            continue;
+        }
+        if (!is_big) {
+            big = BigInteger(fixnum);
+        }
+        big = big_integer_function[function](big, next->ToBigInteger());
+        is_big = !big.FitsInt64();
+        if (!is_big) {
+            fixnum = big.ToInt64();
+        }
+    }
+    if (is_big) {
+        return MakeNumber(std::move(big));
+    }
+    return MakeNumber(fixnum);
+}
+
+std::shared_ptr<Number> ApplyUnaryIntegerFunction(SymbolId function,
+                                                  const std::shared_ptr<Object>& object) {
+    return unary_integer_functions[function](*View<Number>(object));
+}
+
+namespace {
+
+// the longest vector make-vector builds, a longer one is more likely a mistake than meant
+const int64_t kMaxVectorLength = int64_t(1) << 28;
+
+void CheckArgumentCount(Arguments args, size_t count) {
+    if (args.size() != count) {
+        throw RuntimeError("wrong number of arguments\n");
+    }
+}
+
+const NumericVector* VectorArgument(const std::shared_ptr<Object>& argument) {
+    const NumericVector* vector = View<NumericVector>(argument);
+    if (!vector) {
+        throw RuntimeError("arguments are belong to different types\n");
+    }
+    return vector;
+}
+
+// The value of a number which is to become a vector element.
+int64_t ElementArgument(const std::shared_ptr<Object>& argument) {
+    const Number* number = NumberArgument(argument);
+    if (!number->IsFixnum()) {
+        throw RuntimeError("vector elements must fit in 64 bits\n");
+    }
+    return number->GetValue();
+}
+
+// (function e0 e1 ...) for the elements of a vector, one Number at a time.
+std::shared_ptr<Object> ApplyToElements(SymbolId function, std::span<const int64_t> elements) {
+    std::vector<std::shared_ptr<Object>> numbers;
+    numbers.reserve(elements.size());
+    for (int64_t element : elements) {
+        numbers.push_back(MakeNumber(element));
+    }
+    return ApplyBinaryIntegerFunction(function, numbers);
+}
+
+std::shared_ptr<Object> MakeVectorList(std::span<const int64_t> elements) {
+    if (elements.empty()) {
+        return New<Symbol>(EMPTY_LIST);
+    }
+    std::vector<std::shared_ptr<Object>> numbers;
+    numbers.reserve(elements.size());
+    for (int64_t element : elements) {
+        numbers.push_back(MakeNumber(element));
+    }
+    return MakeList(numbers);
+}
+
+}  // namespace
+
+const BuiltinTable<std::function<std::shared_ptr<Object>(Arguments)>> vector_functions = {
+    {VECTOR,
+     [](Arguments args) -> std::shared_ptr<Object> {
+         std::vector<int64_t> elements;
+         elements.reserve(args.size());
+         for (const std::shared_ptr<Object>& argument : args) {
+             elements.push_back(ElementArgument(argument));
+         }
+         return New<NumericVector>(std::move(elements));
+     }},
+    {MAKE_VECTOR,
+     [](Arguments args) -> std::shared_ptr<Object> {
+         if (args.empty() || args.size() > 2) {
+             throw RuntimeError("wrong number of arguments\n");
+         }
+         int64_t length = ElementArgument(args[0]);
+         if (length < 0 || length > kMaxVectorLength) {
+             throw RuntimeError("wrong vector length\n");
+         }
+         int64_t fill = args.size() == 2 ? ElementArgument(args[1]) : 0;
+         return New<NumericVector>(std::vector<int64_t>(length, fill));
+     }},
+    {VECTOR_LENGTH,
+     [](Arguments args) -> std::shared_ptr<Object> {
+         CheckArgumentCount(args, 1);
+         return MakeNumber(VectorArgument(args[0])->GetElements().size());
+     }},
+    {VECTOR_REF,
+     [](Arguments args) -> std::shared_ptr<Object> {
+         CheckArgumentCount(args, 2);
+         std::span<const int64_t> elements = VectorArgument(args[0])->GetElements();
+         const Number* index = NumberArgument(args[1]);
+         if (!index->IsFixnum() || index->GetValue() < 0 ||
+             static_cast<uint64_t>(index->GetValue()) >= elements.size()) {
+             throw RuntimeError("vector has not this element\n");
+         }
+         return MakeNumber(elements[index->GetValue()]);
+     }},
+    {LIST_TO_VECTOR,
+     [](Arguments args) -> std::shared_ptr<Object> {
+         CheckArgumentCount(args, 1);
+         std::vector<int64_t> elements;
+         std::shared_ptr<Object> jumper = args[0];
+         for (; Is<Cell>(jumper); jumper = View<Cell>(jumper)->GetSecond()) {
+             elements.push_back(ElementArgument(View<Cell>(jumper)->GetFirst()));
+         }
+         Symbol* rest = View<Symbol>(jumper);
+         if (jumper && !(rest && rest->GetId() == EMPTY_LIST)) {
+             throw RuntimeError("arguments are belong to different types\n");
+         }
+         return New<NumericVector>(std::move(elements));
+     }},
+    {VECTOR_TO_LIST, [](Arguments args) {
+         CheckArgumentCount(args, 1);
+         return MakeVectorList(VectorArgument(args[0])->GetElements());
+     }}};
+
+std::shared_ptr<Object> ApplyVectorArithmetic(SymbolId function, Arguments args) {
+    if (args.size() == 1) {
+        std::span<const int64_t> elements = VectorArgument(args[0])->GetElements();
+        if (elements.empty()) {
+            return MakeNumber(ApplyEmptyIntegerFunction(function));
+        }
+        int64_t sum;
+        if (function == PLUS && SumElements(elements, &sum)) {
+            return MakeNumber(sum);
+        }
+        if (function == MAX || function == MIN) {
+            return MakeNumber(ExtremeElement(elements, function == MAX));
+        }
+        // a sum out of range needs bignums, products and quotients overflow long before a
+        // kernel would pay off
+        return ApplyToElements(function, elements);
+    }
+    size_t length = 0;
+    bool has_vector = false;
+    for (const std::shared_ptr<Object>& argument : args) {
+        if (const NumericVector* vector = View<NumericVector>(argument)) {
+            if (has_vector && vector->GetElements().size() != length) {
+                throw RuntimeError("vectors have different lengths\n");
+            }
+            length = vector->GetElements().size();
+            has_vector = true;
+        } else if (!Is<Number>(argument)) {
+            throw RuntimeError("arguments are belong to different types\n");
+        }
+    }
+    if (!has_vector) {
+        throw RuntimeError("arguments are belong to different types\n");
+    }
+    std::vector<int64_t> result;
+    // a number as an operand is spread over a vector of its own
+    std::vector<int64_t> spread;
+    for (size_t i = 0; i < args.size(); ++i) {
+        std::span<const int64_t> operand;
+        if (const NumericVector* vector = View<NumericVector>(args[i])) {
+            operand = vector->GetElements();
+        } else {
+            spread.assign(length, ElementArgument(args[i]));
+            operand = spread;
+        }
+        if (i == 0) {
+            result.assign(operand.begin(), operand.end());
+        } else if (!ApplyElementwise(function, result, operand)) {
+            throw RuntimeError("vector elements must fit in 64 bits\n");
+        }
+    }
+    return New<NumericVector>(std::move(result));
+}
+
+bool ApplyVectorComparison(SymbolId function, const NumericVector& vector) {
+    return IsChainOrdered(function, vector.GetElements());
+}
+
+std::shared_ptr<Object> ApplyVectorFunction(SymbolId function, Arguments args) {
+    return vector_functions[function](args);
+}
+
+std::shared_ptr<Object> ApplyMutableBoolFunction(SymbolId function,
+                                                 const std::shared_ptr<Object>& lhs,
+                                                 const std::shared_ptr<Object>& rhs) {
+    return or_and_function[function]({lhs, rhs});
+}
+
+std::shared_ptr<Object> ApplyConstructorFunction(SymbolId function, Arguments args) {
+    return construct_functions[function](args);
+}
+
+const BuiltinTable<std::function<std::shared_ptr<Object>(Arguments)>> list_functions = {
+    {LENGTH, [](Arguments args) {
+         CheckArgumentCount(args, 1);
+         Symbol* empty = View<Symbol>(args[0]);
+         if (!args[0] || (empty && empty->GetId() == EMPTY_LIST)) {
+             return MakeNumber(0);
+         }
+         const Cell* list = View<Cell>(args[0]);
+         const Object* end = nullptr;
+         size_t length = list ? list->CountCells(&end) : 0;
+         if (!list || end) {
+             throw RuntimeError("arguments are belong to different types\n");
+         }
+         return MakeNumber(static_cast<int64_t>(length));
+     }}};
+
+std::shared_ptr<Object> ApplyListFunction(SymbolId function, Arguments args) {
+    return list_functions[function](args);
+}
+
+std::shared_ptr<Object> ApplyGetterFunction(SymbolId function,
+                                            const std::shared_ptr<Object>& object) {
+    return getter_functions[function](object);
+}
+
+std::shared_ptr<Object> ApplyGetterArgumentFunction(SymbolId function,
+                                                    const std::shared_ptr<Object>& lhs,
+                                                    const std::shared_ptr<Object>& rhs) {
+    return getter_argument_functions[function]({lhs, rhs});
+}
+
+const BuiltinTable<std::shared_ptr<Object>> apply_function = {
+    {QUOTE, nullptr},
+    {AND, std::make_shared<NonTypeBinaryBoolFunction>()},
+    {OR, std::make_shared<NonTypeBinaryBoolFunction>()},
+    {NOT, std::make_shared<OnlyUnaryBoolFunction>()},
+    {IS_BOOLEAN, std::make_shared<UnaryBoolFunction>()},
+    {IS_NUMBER, std::make_shared<UnaryBoolFunction>()},
+    {IS_PAIR, std::make_shared<UnaryBoolFunction>()},
+    {IS_NULL, std::make_shared<UnaryBoolFunction>()},
+    {IS_LIST, std::make_shared<UnaryBoolFunction>()},
+    {CONS, std::make_shared<ConstructorFunction>()},
+    {LIST, std::make_shared<ConstructorFunction>()},
+    {CAR, std::make_shared<GetterFunction>()},
+    {CDR, std::make_shared<GetterFunction>()},
+    {LIST_REF, std::make_shared<GetterFunction>()},
+    {LIST_TAIL, std::make_shared<GetterFunction>()},
+    {LENGTH, std::make_shared<ListFunction>()},
+    {EQUAL, std::make_shared<BinaryBoolFunction>()},
+    {LESS, std::make_shared<BinaryBoolFunction>()},
+    {GREATER, std::make_shared<BinaryBoolFunction>()},
+    {LESS_EQUAL, std::make_shared<BinaryBoolFunction>()},
+    {GREATER_EQUAL, std::make_shared<BinaryBoolFunction>()},
+    {PLUS, std::make_shared<BinaryIntegerFunction>()},
+    {MINUS, std::make_shared<BinaryIntegerFunction>()},
+    {MULTIPLY, std::make_shared<BinaryIntegerFunction>()},
+    {DIVIDE, std::make_shared<BinaryIntegerFunction>()},
+    {MAX, std::make_shared<BinaryIntegerFunction>()},
+    {MIN, std::make_shared<BinaryIntegerFunction>()},
+    {ABS, std::make_shared<UnaryIntegerFunction>()},
+    {IS_VECTOR, std::make_shared<UnaryBoolFunction>()},
+    {VECTOR, std::make_shared<VectorFunction>()},
+    {MAKE_VECTOR, std::make_shared<VectorFunction>()},
+    {VECTOR_LENGTH, std::make_shared<VectorFunction>()},
+    {VECTOR_REF, std::make_shared<VectorFunction>()},
+    {LIST_TO_VECTOR, std::make_shared<VectorFunction>()},
+    {VECTOR_TO_LIST, std::make_shared<VectorFunction>()},
+    {RUNTIME_STATS, std::make_shared<StatsFunction>()}};
+
+std::string NumericVector::ToString() {
+    std::string output = "#(";
+    for (size_t i = 0; i < elements_.size(); ++i) {
+        if (i) {
+            output += ' ';
+        }
+        output += std::to_string(elements_[i]);
+    }
+    return output + ")";
+}
+
+std::shared_ptr<Object> MakeList(Arguments elements, std::shared_ptr<Object> tail) {
+    // a run can't be longer than run_ can count, longer lists are built from the last run back
+    const size_t kMaxRunCells = std::numeric_limits<uint32_t>::max();
+    for (size_t end = elements.size(); end > 0;) {
+        size_t begin = end > kMaxRunCells ? end - kMaxRunCells : 0;
+        CountAllocation(Cell::kType, sizeof(Cell), end - begin);
+        Slab::Handle slab = Slab::Create(end - begin);
+        SlabAllocator<Cell> allocator(slab.get());
+        std::shared_ptr<Cell> head = std::allocate_shared<Cell>(allocator, elements[begin]);
+        Cell* last = head.get();
+        for (size_t i = begin + 1; i < end; ++i) {
+            std::shared_ptr<Cell> cell = std::allocate_shared<Cell>(allocator, elements[i]);
+            last->run_ = static_cast<uint32_t>(end - i);
+            Cell* next = cell.get();
+            last->second_ = std::move(cell);
+            last = next;
+        }
+        last->second_ = std::move(tail);
+        tail = std::move(head);
+        end = begin;
+    }
+    return tail;
+}
+
+const Cell* Cell::RunSuccessor(size_t step) const {
+    // the distance to the next cell is the same for every cell of the run
+    const std::byte* address = reinterpret_cast<const std::byte*>(this);
+    ptrdiff_t stride = reinterpret_cast<const std::byte*>(second_.get()) - address;
+    return reinterpret_cast<const Cell*>(address + static_cast<ptrdiff_t>(step) * stride);
+}
+
+const Cell* Cell::Skip(uint64_t count) const {
+    const Cell* cell = this;
+    while (count) {
+        if (cell->run_) {
+            uint64_t step = std::min<uint64_t>(count, cell->run_);
+            cell = cell->RunSuccessor(step);
+            count -= step;
+        } else if (Is<Cell>(cell->second_)) {
+            cell = static_cast<const Cell*>(cell->second_.get());
+            --count;
+        } else {
+            return nullptr;
+        }
+    }
+    return cell;
+}
+
+size_t Cell::CountCells(const Object** end) const {
+    size_t count = 1;
+    const Cell* cell = this;
+    while (true) {
+        if (cell->run_) {
+            count += cell->run_;
+            cell = cell->RunSuccessor(cell->run_);
+        }
+        if (!Is<Cell>(cell->second_)) {
+            *end = cell->second_.get();
+            return count;
+        }
+        cell = static_cast<const Cell*>(cell->second_.get());
+        ++count;
+    }
+}
+
+std::string Cell::ToString() {
+    std::string output;
+    Print(this, &output);
+    return output;
+}
+
+// Exclusively owned cells are rotated until their first is not one, then the root is freed and its
+// second becomes the next root: the freed cell has nothing left to release recursively.
+void Cell::ReleaseCells(std::shared_ptr<Object> root) {
+    while (Is<Cell>(root) && root.use_count() == 1) {
+        Cell* cell = View<Cell>(root);
+        std::shared_ptr<Object>& first = cell->first_;
+        if (Is<Cell>(first) && first.use_count() == 1) {
+            std::shared_ptr<Object> left = std::move(first);
+            first = std::move(View<Cell>(left)->second_);
+            View<Cell>(left)->second_ = std::move(root);
+            View<Cell>(left)->run_ = 0;
+            root = std::move(left);
+        } else {
+            std::shared_ptr<Object> rest = std::move(cell->second_);
+            root = std::move(rest);
+        }
+    }
+}
+
+Cell::~Cell() {
+    ReleaseCells(std::move(first_));
+    ReleaseCells(std::move(second_));
+}
+
+bool IsBuiltinCall(const std::shared_ptr<Object>& head) {
+    return Is<Symbol>(head) && IsBuiltinFunction(View<Symbol>(head)->GetId());
+}
+
+bool IsQuoteForm(const std::shared_ptr<Object>& object) {
+    Cell* cell = View<Cell>(object);
+    return cell && Is<Symbol>(cell->GetFirst()) &&
+           View<Symbol>(cell->GetFirst())->GetId() == QUOTE;
+}
+
+std::shared_ptr<Object> QuotedDatum(const std::shared_ptr<Object>& form) {
+    Cell* operands = View<Cell>(View<Cell>(form)->GetSecond());
+    return operands ? operands->GetFirst() : nullptr;
+}
+
+bool ReturnsArgument(SymbolId function) {
+    return function == CAR || function == CDR || function == LIST_REF || function == LIST_TAIL ||
+           function == AND || function == OR;
+}
+
+bool MayYieldBuiltin(const std::shared_ptr<Object>& object) {
+    if (IsQuoteForm(object)) {
+        return IsBuiltinCall(QuotedDatum(object));
+    }
+    Cell* cell = View<Cell>(object);
+    if (!cell) {
+        return IsBuiltinCall(object);
+    }
+    if (Is<Cell>(cell->GetFirst())) {
+        return true;
+    }
+    if (!IsBuiltinCall(cell->GetFirst())) {
+        return false;
+    }
+    return ReturnsArgument(View<Symbol>(cell->GetFirst())->GetId());
+}
+
+bool IsProperList(const std::shared_ptr<Object>& object) {
+    const Cell* cell = View<Cell>(object);
+    const Object* end = object.get();
+    if (cell) {
+        cell->CountCells(&end);
+    }
+    return !end;
+}
+
+std::shared_ptr<Object> DefinitePointer(const std::shared_ptr<Object>& object) {
+    if (!Is<Symbol>(object)) {
+        return object;
+    }
+    SymbolId id = View<Symbol>(object)->GetId();
+    if (id == TRUE_LITERAL || id == FALSE_LITERAL) {
+        return MakeBoolean(id == TRUE_LITERAL);
+    }
+    return object;
+}
+
+void CollectArguments(const std::shared_ptr<Object>& list,
+                      std::vector<std::shared_ptr<Object>>* arguments) {
+    std::shared_ptr<Object> argument_jumper = list;
+    while (argument_jumper) {
+        if (Is<Cell>(argument_jumper)) {
+            arguments->emplace_back(DefinitePointer(View<Cell>(argument_jumper)->GetFirst()));
+            argument_jumper = View<Cell>(argument_jumper)->GetSecond();
+            continue;
+        }
+        arguments->emplace_back(DefinitePointer(argument_jumper));
+        break;
+    }
+}
+
+std::shared_ptr<Object> ApplyBuiltinFunction(SymbolId function, Arguments args) {
+    if (!apply_function[function]) {
+        throw RuntimeError("this function can't be applied\n");
+    }
+    if (RuntimeStats* stats = StatsScope::Current()) {
+        ScopedTimer timer(&stats->builtins[function]);
+        return apply_function[function]->Apply(function, args);
+    }
+    return apply_function[function]->Apply(function, args);
+}
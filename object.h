@@ -4,121 +4,193 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <span>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+#include "arena.h"
+#include "bignum.h"
 #include "error.h"
+#include "runtime_stats.h"
+#include "symbol_table.h"
+
+class Object;
+
+// Arguments of a builtin call: a window over the caller's storage, never copied.
+using Arguments = std::span<const std::shared_ptr<Object>>;
+
+// Concrete kind of an object, stored inline so Is/As are a byte compare instead of RTTI.
+enum class ObjectType : uint8_t {
+    DOT,
+    NUMBER,
+    SYMBOL,
+    CELL,
+    NULLPTR,
+    BOOLEAN,
+    NUMERIC_VECTOR,
+    UNARY_BOOL_FUNCTION,
+    BINARY_BOOL_FUNCTION,
+    BINARY_INTEGER_FUNCTION,
+    UNARY_INTEGER_FUNCTION,
+    ONLY_UNARY_BOOL_FUNCTION,
+    NON_TYPE_BINARY_BOOL_FUNCTION,
+    CONSTRUCTOR_FUNCTION,
+    GETTER_FUNCTION,
+    VECTOR_FUNCTION,
+    LIST_FUNCTION,
+    STATS_FUNCTION,
+    CLOSURE
+};
+static_assert(static_cast<size_t>(ObjectType::CLOSURE) + 1 == kObjectTypeCount);
 
 class Object : public std::enable_shared_from_this<Object> {
 public:
+    explicit Object(ObjectType type) : type_{type} {
+    }
     virtual ~Object() = default;
+    ObjectType GetType() const {
+        return type_;
+    }
     virtual std::string ToString() = 0;
-    virtual std::shared_ptr<Object> Apply(const std::string&,
-                                          const std::vector<std::shared_ptr<Object>>&) = 0;
+    virtual std::shared_ptr<Object> Apply(SymbolId, Arguments) = 0;
+
+private:
+    ObjectType type_;
 };
 
+template <class T>
+bool Is(const Object* obj) {
+    return obj && obj->GetType() == T::kType;
+}
+
+template <class T>
+bool Is(const std::shared_ptr<Object>& obj) {
+    return Is<T>(obj.get());
+}
+
+template <class T>
+std::shared_ptr<T> As(const std::shared_ptr<Object>& obj) {
+    if constexpr (std::is_same_v<T, Object>) {
+        return obj;
+    } else {
+        return Is<T>(obj) ? std::static_pointer_cast<T>(obj) : nullptr;
+    }
+}
+
+// Non-owning view: no refcount traffic, valid while the owner of obj is alive.
+template <class T>
+T* View(const std::shared_ptr<Object>& obj) {
+    return Is<T>(obj) ? static_cast<T*>(obj.get()) : nullptr;
+}
+
 class Dot : public Object {
 public:
+    static constexpr ObjectType kType = ObjectType::DOT;
+
+    Dot() : Object(kType) {
+    }
     virtual ~Dot() override = default;
     virtual std::string ToString() override {
         return ".";
     }
-    virtual std::shared_ptr<Object> Apply(const std::string&,
-                                          const std::vector<std::shared_ptr<Object>>&) override {
+    virtual std::shared_ptr<Object> Apply(SymbolId, Arguments) override {
         return nullptr;
     }
 };
 
 class Number : public Object {
 public:
-    virtual ~Number() override = default;
+    static constexpr ObjectType kType = ObjectType::NUMBER;
+
+    virtual ~Number() override {
+        if (is_big_) {
+            delete big_;
+        }
+    }
     virtual std::string ToString() override {
-        return std::to_string(value_);
+        return is_big_ ? big_->ToString() : std::to_string(value_);
     }
-    virtual std::shared_ptr<Object> Apply(const std::string&,
-                                          const std::vector<std::shared_ptr<Object>>&) override {
+    virtual std::shared_ptr<Object> Apply(SymbolId, Arguments) override {
         return nullptr;
     }
-    Number(int64_t value) : value_{value} {
+    Number(int64_t value) : Object(kType), value_{value} {
     }
-    int GetValue() const {
+    // big must not fit in an int64_t, MakeNumber takes care of that
+    explicit Number(BigInteger big)
+        : Object(kType), is_big_{true}, big_{new BigInteger(std::move(big))} {
+    }
+    Number(const Number& other) : Object(kType), is_big_{other.is_big_} {
+        if (is_big_) {
+            big_ = new BigInteger(*other.big_);
+        } else {
+            value_ = other.value_;
+        }
+    }
+    Number& operator=(const Number&) = delete;
+
+    // Whether the value is held inline, which is the case for everything an int64_t can hold.
+    bool IsFixnum() const {
+        return !is_big_;
+    }
+    // The value of a fixnum.
+    int64_t GetValue() const {
         return value_;
     }
+    BigInteger ToBigInteger() const {
+        return is_big_ ? *big_ : BigInteger(value_);
+    }
+    bool IsNegative() const {
+        return is_big_ ? big_->IsNegative() : value_ < 0;
+    }
 
 private:
-    int64_t value_;
+    // a fixnum takes no more room than before bignums existed, the flag fits in the padding
+    bool is_big_ = false;
+    union {
+        int64_t value_;
+        BigInteger* big_;
+    };
 };
 
 class Symbol : public Object {
 public:
+    static constexpr ObjectType kType = ObjectType::SYMBOL;
+
     virtual ~Symbol() override = default;
     virtual std::string ToString() override {
-        return name_;
+        return SymbolName(id_);
     }
-    virtual std::shared_ptr<Object> Apply(const std::string&,
-                                          const std::vector<std::shared_ptr<Object>>&) override {
+    virtual std::shared_ptr<Object> Apply(SymbolId, Arguments) override {
         return nullptr;
     }
-    Symbol(const std::string& name) : name_{name} {
+    Symbol(SymbolId id) : Object(kType), id_{id} {
+    }
+    Symbol(std::string_view name) : Object(kType), id_{Intern(name)} {
+    }
+    SymbolId GetId() const {
+        return id_;
     }
     const std::string& GetName() const {
-        return name_;
+        return SymbolName(id_);
     }
 
 private:
-    std::string name_;
+    SymbolId id_;
 };
 
 class Cell : public Object {
 public:
-    virtual ~Cell() override = default;
+    static constexpr ObjectType kType = ObjectType::CELL;
 
-    virtual std::string ToString() override {
-        std::shared_ptr<Cell> first_cell = std::dynamic_pointer_cast<Cell>(first_);
-        std::shared_ptr<Cell> second_cell = std::dynamic_pointer_cast<Cell>(second_);
-        if (GetFirst() && GetSecond() && !first_cell && !second_cell) {
-            return "(" + first_->ToString() + " . " + second_->ToString() + ")";
-        }
-        if (!first_ && !second_) {
-            return "(())";
-        }
-        if (!first_) {
-            if (second_cell) {
-                return second_->ToString();
-            }
-            return "(" + second_->ToString() + ")";
-        }
-        if (!second_) {
-            if (first_cell) {
-                return first_->ToString();
-            }
-            return "(" + first_->ToString() + ")";
-        }
-        if (second_cell) {
-            std::shared_ptr<Cell> second_cell_first =
-                std::dynamic_pointer_cast<Cell>(second_cell->GetFirst());
-            std::shared_ptr<Cell> second_cell_second =
-                std::dynamic_pointer_cast<Cell>(second_cell->GetSecond());
-            if (!second_cell_second) {
-                if (second_cell->GetSecond()) {
-                    return "(" + first_->ToString() + " " + second_cell->GetFirst()->ToString() +
-                           " . " + second_cell->GetSecond()->ToString() + ")";
-                }
-                return "(" + first_->ToString() + " " + second_cell->GetFirst()->ToString() + ")";
-            }
-            return "(" + first_->ToString() + " " + second_cell->GetFirst()->ToString() + " " +
-                   second_cell_second->GetFirst()->ToString() + ")";
-        }
-        return "(" + first_->ToString() + " " + second_->ToString() + ")";
-    }
-    virtual std::shared_ptr<Object> Apply(const std::string&,
-                                          const std::vector<std::shared_ptr<Object>>&) override {
+    virtual ~Cell() override;
+
+    virtual std::string ToString() override;
+    virtual std::shared_ptr<Object> Apply(SymbolId, Arguments) override {
         return nullptr;
     }
     Cell(std::shared_ptr<Object> first = nullptr, std::shared_ptr<Object> second = nullptr)
-        : first_{nullptr}, second_{nullptr} {
-        SetFirst(first);
-        SetSecond(second);
+        : Object(kType), first_{std::move(first)}, second_{std::move(second)} {
     }
     std::shared_ptr<Object> GetFirst() const {
         return first_;
@@ -126,54 +198,81 @@ public:
     std::shared_ptr<Object> GetSecond() const {
         return second_;
     }
+    // non-owning access for walks which don't keep what they visit
+    Object* ViewFirst() const {
+        return first_.get();
+    }
+    Object* ViewSecond() const {
+        return second_.get();
+    }
+
+    // How many of the cells after this one belong to its run, see run_.
+    size_t GetRunLength() const {
+        return run_;
+    }
+    // The cell count cdrs down the list, nullptr if the list ends before it.
+    const Cell* Skip(uint64_t count) const;
+    // The number of cells of the list; *end is set to the last cdr, nullptr for a proper list.
+    size_t CountCells(const Object** end) const;
 
     template <typename T>
     void SetFirst(std::shared_ptr<T> object) {
-        first_ = std::dynamic_pointer_cast<T>(first_);
-        first_ = object;
+        first_ = std::move(object);
     }
 
+    // Only for cells being built: a cell of a run keeps its second.
     template <typename T>
     void SetSecond(std::shared_ptr<T> object) {
-        second_ = std::dynamic_pointer_cast<T>(second_);
-        second_ = object;
+        second_ = std::move(object);
     }
 
 private:
+    friend std::shared_ptr<Object> MakeList(Arguments elements, std::shared_ptr<Object> tail);
+
+    // releases a tree of cells without recursing once per cell
+    static void ReleaseCells(std::shared_ptr<Object> root);
+    // The cell step cdrs down, step being at most run_.
+    const Cell* RunSuccessor(size_t step) const;
+
+    // How many of the next cells of the list come right after this one in memory, evenly spaced.
+    // MakeList lays out lists like that, and walks cross such a run in one step. Declared first
+    // to sit in the padding at the end of Object.
+    uint32_t run_ = 0;
     std::shared_ptr<Object> first_{nullptr};
     std::shared_ptr<Object> second_{nullptr};
 };
 
 class Nullptr : public Object {
 public:
+    static constexpr ObjectType kType = ObjectType::NULLPTR;
+
+    Nullptr() : Object(kType) {
+    }
     virtual ~Nullptr() override = default;
     virtual std::string ToString() override {
         return "()";
     }
-    virtual std::shared_ptr<Object> Apply(const std::string&,
-                                          const std::vector<std::shared_ptr<Object>>&) override {
+    virtual std::shared_ptr<Object> Apply(SymbolId, Arguments) override {
         return nullptr;
     }
 };
 
 class Boolean : public Object {
 public:
+    static constexpr ObjectType kType = ObjectType::BOOLEAN;
+
     virtual ~Boolean() override = default;
     virtual std::string ToString() override {
         return (value_ ? "#t" : "#f");
     }
-    virtual std::shared_ptr<Object> Apply(const std::string&,
-                                          const std::vector<std::shared_ptr<Object>>&) override {
+    virtual std::shared_ptr<Object> Apply(SymbolId, Arguments) override {
         return nullptr;
     }
-    Boolean(bool value = false) : value_{value} {
+    Boolean(bool value = false) : Object(kType), value_{value} {
     }
-    Boolean(std::shared_ptr<Object> object) {
-        if (std::dynamic_pointer_cast<Boolean>(object)) {
-            std::shared_ptr<Boolean> bool_object = std::dynamic_pointer_cast<Boolean>(object);
-            value_ = bool_object->Get();
-        } else {
-            value_ = true;
+    Boolean(const std::shared_ptr<Object>& object) : Object(kType), value_{true} {
+        if (object && object->GetType() == kType) {
+            value_ = static_cast<const Boolean*>(object.get())->value_;
         }
     }
     void Set(bool value) {
@@ -187,161 +286,219 @@ private:
     bool value_;
 };
 
-///////////////////////////////////////////////////////////////////////////////
+// Integers which fit in an int64_t, stored contiguously and written #(1 2 3). Never changed
+// once built, so builtins hand the storage straight to the kernels of vector_kernels.h.
+class NumericVector : public Object {
+public:
+    static constexpr ObjectType kType = ObjectType::NUMERIC_VECTOR;
 
-template <class T>
-std::shared_ptr<T> As(const std::shared_ptr<Object>& obj) {
-    return std::dynamic_pointer_cast<T>(obj);
-}
+    explicit NumericVector(std::vector<int64_t> elements)
+        : Object(kType), elements_{std::move(elements)} {
+    }
+    virtual ~NumericVector() override = default;
+    virtual std::string ToString() override;
+    virtual std::shared_ptr<Object> Apply(SymbolId, Arguments) override {
+        return nullptr;
+    }
+    std::span<const int64_t> GetElements() const {
+        return elements_;
+    }
 
-template <class T>
-bool Is(const std::shared_ptr<Object>& obj) {
-    return std::dynamic_pointer_cast<T>(obj) != nullptr;
-}
+private:
+    std::vector<int64_t> elements_;
+};
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-int64_t ApplyEmptyIntegerFunction(const std::string& function);
-bool ApplyEmptyBoolMutableFunction(const std::string& function);
-
-bool ApplyUnaryBoolFunction(const std::string& function, const std::shared_ptr<Object> object);
-bool ApplyBinaryBoolFunction(const std::string& function, const std::shared_ptr<Object> lhs,
-                             const std::shared_ptr<Object> rhs);
-
-int64_t ApplyBinaryIntegerFunction(const std::string& function, const std::shared_ptr<Object> lhs,
-                                   const std::shared_ptr<Object> rhs);
-int64_t ApplyUnaryIntegerFunction(const std::string& function,
-                                  const std::shared_ptr<Object> object);
-std::shared_ptr<Object> ApplyMutableBoolFunction(const std::string& function,
-                                                 const std::shared_ptr<Object> lhs,
-                                                 const std::shared_ptr<Object> rhs);
-
-std::shared_ptr<Object> ApplyConstructorFunction(const std::string& function,
-                                                 const std::shared_ptr<Object> lhs,
-                                                 const std::shared_ptr<Object> rhs);
-
-std::shared_ptr<Object> ApplyGetterFunction(const std::string& function,
-                                            const std::shared_ptr<Object> object);
-
-std::shared_ptr<Object> ApplyGetterArgumentFunction(const std::string& function,
-                                                    const std::shared_ptr<Object> lhs,
-                                                    const std::shared_ptr<Object> rhs);
+// Booleans, the empty list and small integers are preallocated once for the whole program.
+// The returned pointers own nothing, so handing them out and copying them neither allocates
+// nor touches a reference count.
+std::shared_ptr<Boolean> MakeBoolean(bool value);
+std::shared_ptr<Number> MakeNumber(int64_t value);
+// A fixnum whenever value fits in one.
+std::shared_ptr<Number> MakeNumber(BigInteger value);
+std::shared_ptr<Nullptr> MakeNullptr();
+// The list of elements, ending in tail instead of the empty list if there is one. Its cells are
+// allocated back to back as runs, so length, list?, list-ref and list-tail step over them by
+// address rather than one by one.
+std::shared_ptr<Object> MakeList(Arguments elements, std::shared_ptr<Object> tail = nullptr);
+
+bool IsTruthy(const std::shared_ptr<Object>& object);
+
+// Whether head names a builtin function, i.e. (head ...) is a call.
+bool IsBuiltinCall(const std::shared_ptr<Object>& head);
+// Whether object is (quote datum); 'datum is read as the same form.
+bool IsQuoteForm(const std::shared_ptr<Object>& object);
+// The datum of a quote form.
+std::shared_ptr<Object> QuotedDatum(const std::shared_ptr<Object>& form);
+// Builtins which return one of their arguments or a part of it, so the result can be anything.
+bool ReturnsArgument(SymbolId function);
+// False only if evaluating object can't produce a builtin function name. Calc applies a list
+// as soon as its evaluated head is one, even inside an argument list, so an evaluator can't
+// treat an argument for which this is true as a plain value.
+bool MayYieldBuiltin(const std::shared_ptr<Object>& object);
+bool IsProperList(const std::shared_ptr<Object>& object);
+// Turns the #t/#f symbols produced by the parser into booleans.
+std::shared_ptr<Object> DefinitePointer(const std::shared_ptr<Object>& object);
+// Appends the elements of an evaluated argument list, including a dotted tail, to arguments.
+void CollectArguments(const std::shared_ptr<Object>& list,
+                      std::vector<std::shared_ptr<Object>>* arguments);
+std::shared_ptr<Object> ApplyBuiltinFunction(SymbolId function, Arguments args);
+
+int64_t ApplyEmptyIntegerFunction(SymbolId function);
+bool ApplyEmptyBoolMutableFunction(SymbolId function);
+
+bool ApplyUnaryBoolFunction(SymbolId function, const std::shared_ptr<Object>& object);
+bool ApplyBinaryBoolFunction(SymbolId function, const Number& lhs, const Number& rhs);
+
+// Combines numbers left to right, throwing RuntimeError at an argument which is not a number.
+// Fixnums are combined with overflow checks, and only a result out of the int64_t range
+// switches to BigInteger; one back in it is a fixnum again. With numeric vectors among the
+// arguments it goes to ApplyVectorArithmetic.
+std::shared_ptr<Object> ApplyBinaryIntegerFunction(SymbolId function, Arguments numbers);
+// A lone vector stands for its elements, (+ #(1 2 3)) is (+ 1 2 3). Otherwise the function is
+// applied elementwise to vectors of one length, a number standing for a vector filled with it.
+std::shared_ptr<Object> ApplyVectorArithmetic(SymbolId function, Arguments args);
+// Like a comparison of the elements of vector, (< #(1 2 3)) is (< 1 2 3).
+bool ApplyVectorComparison(SymbolId function, const NumericVector& vector);
+// The constructors and accessors of numeric vectors.
+std::shared_ptr<Object> ApplyVectorFunction(SymbolId function, Arguments args);
+std::shared_ptr<Number> ApplyUnaryIntegerFunction(SymbolId function,
+                                                  const std::shared_ptr<Object>& object);
+std::shared_ptr<Object> ApplyMutableBoolFunction(SymbolId function,
+                                                 const std::shared_ptr<Object>& lhs,
+                                                 const std::shared_ptr<Object>& rhs);
+
+std::shared_ptr<Object> ApplyConstructorFunction(SymbolId function, Arguments args);
+// Functions of whole lists.
+std::shared_ptr<Object> ApplyListFunction(SymbolId function, Arguments args);
+
+std::shared_ptr<Object> ApplyGetterFunction(SymbolId function,
+                                            const std::shared_ptr<Object>& object);
+
+std::shared_ptr<Object> ApplyGetterArgumentFunction(SymbolId function,
+                                                    const std::shared_ptr<Object>& lhs,
+                                                    const std::shared_ptr<Object>& rhs);
 
 struct UnaryBoolFunction : public Object {
+    static constexpr ObjectType kType = ObjectType::UNARY_BOOL_FUNCTION;
+
+    UnaryBoolFunction() : Object(kType) {
+    }
     virtual ~UnaryBoolFunction() override = default;
     virtual std::string ToString() override {
         return "can't print a function\n";
     }
-    virtual std::shared_ptr<Object> Apply(
-        const std::string& func, const std::vector<std::shared_ptr<Object>>& args) override {
+    virtual std::shared_ptr<Object> Apply(SymbolId func, Arguments args) override {
         bool result = true;
         for (const std::shared_ptr<Object>& i : args) {
             result &= ApplyUnaryBoolFunction(func, i);
         }
-        return std::make_shared<Boolean>(result);
+        return MakeBoolean(result);
     }
 };
 
 struct BinaryBoolFunction : public Object {
+    static constexpr ObjectType kType = ObjectType::BINARY_BOOL_FUNCTION;
+
+    BinaryBoolFunction() : Object(kType) {
+    }
     virtual ~BinaryBoolFunction() override = default;
     virtual std::string ToString() override {
         return "can't print a function\n";
     }
-    virtual std::shared_ptr<Object> Apply(
-        const std::string& func, const std::vector<std::shared_ptr<Object>>& args) override {
+    virtual std::shared_ptr<Object> Apply(SymbolId func, Arguments args) override {
+        if (args.size() == 1 && Is<NumericVector>(args[0])) {
+            return MakeBoolean(ApplyVectorComparison(func, *View<NumericVector>(args[0])));
+        }
         if (args.size() < 2) {
-            return std::make_shared<Boolean>(true);
+            return MakeBoolean(true);
         }
-        std::shared_ptr<UnaryBoolFunction> checker_to_same_type =
-            std::make_shared<UnaryBoolFunction>();
+        UnaryBoolFunction checker_to_same_type;
 
-        bool result =
-            As<Boolean>(As<UnaryBoolFunction>(checker_to_same_type)->Apply("number?", args))->Get();
+        bool result = View<Boolean>(checker_to_same_type.Apply(IS_NUMBER, args))->Get();
         if (!result) {
             throw RuntimeError("arguments are belong to different types\n");
         }
         for (size_t i = 1; i < args.size(); ++i) {
-            result &= ApplyBinaryBoolFunction(func, args[i - 1], args[i]);
+            result &= ApplyBinaryBoolFunction(func, *View<Number>(args[i - 1]),
+                                              *View<Number>(args[i]));
         }
-        return std::make_shared<Boolean>(result);
+        return MakeBoolean(result);
     }
 };
 
 struct BinaryIntegerFunction : public Object {
+    static constexpr ObjectType kType = ObjectType::BINARY_INTEGER_FUNCTION;
+
+    BinaryIntegerFunction() : Object(kType) {
+    }
     virtual ~BinaryIntegerFunction() override = default;
     virtual std::string ToString() override {
         return "can't print a function\n";
     }
-    virtual std::shared_ptr<Object> Apply(
-        const std::string& func, const std::vector<std::shared_ptr<Object>>& args) override {
+    virtual std::shared_ptr<Object> Apply(SymbolId func, Arguments args) override {
         if (args.empty()) {
-            return std::make_shared<Number>(ApplyEmptyIntegerFunction(func));
+            return MakeNumber(ApplyEmptyIntegerFunction(func));
         }
-        std::shared_ptr<UnaryBoolFunction> checker_to_same_type =
-            std::make_shared<UnaryBoolFunction>();
-
-        bool is_numbers =
-            As<Boolean>(As<UnaryBoolFunction>(checker_to_same_type)->Apply("number?", args))->Get();
-        if (!is_numbers) {
-            throw RuntimeError("arguments are belong to different types\n");
-        }
-        int64_t result = As<Number>(args[0])->GetValue();
-        for (size_t i = 1; i < args.size(); ++i) {
-            result = ApplyBinaryIntegerFunction(func, std::make_shared<Number>(result), args[i]);
-        }
-
-        return std::make_shared<Number>(result);
+        return ApplyBinaryIntegerFunction(func, args);
     }
 };
 
 struct UnaryIntegerFunction : public Object {
+    static constexpr ObjectType kType = ObjectType::UNARY_INTEGER_FUNCTION;
+
+    UnaryIntegerFunction() : Object(kType) {
+    }
     virtual ~UnaryIntegerFunction() override = default;
     virtual std::string ToString() override {
         return "can't print a function\n";
     }
-    virtual std::shared_ptr<Object> Apply(
-        const std::string& func, const std::vector<std::shared_ptr<Object>>& args) override {
+    virtual std::shared_ptr<Object> Apply(SymbolId func, Arguments args) override {
         if (args.size() != 1) {
             throw RuntimeError("this function must have only one argument\n");
         }
-        std::shared_ptr<UnaryBoolFunction> checker_to_same_type =
-            std::make_shared<UnaryBoolFunction>();
-        bool is_numbers =
-            As<Boolean>(As<UnaryBoolFunction>(checker_to_same_type)->Apply("number?", args))->Get();
+        UnaryBoolFunction checker_to_same_type;
+        bool is_numbers = View<Boolean>(checker_to_same_type.Apply(IS_NUMBER, args))->Get();
         if (!is_numbers) {
             throw RuntimeError("arguments are belong to different types\n");
         }
-        return std::make_shared<Number>(ApplyUnaryIntegerFunction(func, args[0]));
+        return ApplyUnaryIntegerFunction(func, args[0]);
     }
 };
 
 struct OnlyUnaryBoolFunction : public Object {
 public:
+    static constexpr ObjectType kType = ObjectType::ONLY_UNARY_BOOL_FUNCTION;
+
+    OnlyUnaryBoolFunction() : Object(kType) {
+    }
     virtual ~OnlyUnaryBoolFunction() override = default;
     virtual std::string ToString() override {
         return "can't print a function\n";
     }
-    virtual std::shared_ptr<Object> Apply(
-        const std::string& func, const std::vector<std::shared_ptr<Object>>& args) override {
+    virtual std::shared_ptr<Object> Apply(SymbolId func, Arguments args) override {
         if (args.size() != 1) {
             throw RuntimeError("this function must have only one argument\n");
         }
-        return std::make_shared<Boolean>(ApplyUnaryBoolFunction(func, args[0]));
+        return MakeBoolean(ApplyUnaryBoolFunction(func, args[0]));
     }
 };
 
 struct NonTypeBinaryBoolFunction : public Object {
 public:
+    static constexpr ObjectType kType = ObjectType::NON_TYPE_BINARY_BOOL_FUNCTION;
+
+    NonTypeBinaryBoolFunction() : Object(kType) {
+    }
     virtual ~NonTypeBinaryBoolFunction() override = default;
     virtual std::string ToString() override {
         return "can't print a function\n";
     }
-    virtual std::shared_ptr<Object> Apply(
-        const std::string& func, const std::vector<std::shared_ptr<Object>>& args) override {
-        std::shared_ptr<Object> result =
-            std::make_shared<Boolean>(ApplyEmptyBoolMutableFunction(func));
+    virtual std::shared_ptr<Object> Apply(SymbolId func, Arguments args) override {
+        std::shared_ptr<Object> result = MakeBoolean(ApplyEmptyBoolMutableFunction(func));
         for (size_t i = 0; i < args.size(); ++i) {
-            result = ApplyMutableBoolFunction(func, std::make_shared<Boolean>(result), args[i]);
+            result = ApplyMutableBoolFunction(func, result, args[i]);
         }
         return result;
     }
@@ -349,40 +506,93 @@ public:
 
 struct ConstructorFunction : public Object {
 public:
+    static constexpr ObjectType kType = ObjectType::CONSTRUCTOR_FUNCTION;
+
+    ConstructorFunction() : Object(kType) {
+    }
     virtual ~ConstructorFunction() override = default;
     virtual std::string ToString() override {
         return "can't print a function\n";
     }
-    virtual std::shared_ptr<Object> Apply(
-        const std::string& func, const std::vector<std::shared_ptr<Object>>& args) override {
+    virtual std::shared_ptr<Object> Apply(SymbolId func, Arguments args) override {
         if (args.empty()) {
-            return std::make_shared<Symbol>("()");
+            return New<Symbol>(EMPTY_LIST);
         }
-        if (args.size() == 1) {
-            return std::make_shared<Cell>(args[0]);
-        }
-        std::shared_ptr<Cell> result = std::make_shared<Cell>(args[0]);
-        for (size_t i = 1; i < args.size(); ++i) {
-            result = As<Cell>(ApplyConstructorFunction(func, result, args[i]));
-        }
-        return result;
+        return ApplyConstructorFunction(func, args);
     }
 };
 
 struct GetterFunction : public Object {
 public:
+    static constexpr ObjectType kType = ObjectType::GETTER_FUNCTION;
+
+    GetterFunction() : Object(kType) {
+    }
     virtual ~GetterFunction() override = default;
     virtual std::string ToString() override {
         return "can't print a function\n";
     }
-    virtual std::shared_ptr<Object> Apply(
-        const std::string& func, const std::vector<std::shared_ptr<Object>>& args) override {
+    virtual std::shared_ptr<Object> Apply(SymbolId func, Arguments args) override {
+        // car and cdr take a pair, list-ref and list-tail a list and a number
+        bool is_unary = func == CAR || func == CDR;
+        if (args.size() != (is_unary ? 1 : 2)) {
+            throw RuntimeError("wrong number of arguments\n");
+        }
         if (!args[0]) {
             throw RuntimeError("can't do this operation with empty object\n");
         }
-        if (args.size() == 1) {
+        if (is_unary) {
             return ApplyGetterFunction(func, args[0]);
         }
         return ApplyGetterArgumentFunction(func, args[0], args[1]);
     }
-};
\ No newline at end of file
+};
+
+struct VectorFunction : public Object {
+public:
+    static constexpr ObjectType kType = ObjectType::VECTOR_FUNCTION;
+
+    VectorFunction() : Object(kType) {
+    }
+    virtual ~VectorFunction() override = default;
+    virtual std::string ToString() override {
+        return "can't print a function\n";
+    }
+    virtual std::shared_ptr<Object> Apply(SymbolId func, Arguments args) override {
+        return ApplyVectorFunction(func, args);
+    }
+};
+
+struct ListFunction : public Object {
+public:
+    static constexpr ObjectType kType = ObjectType::LIST_FUNCTION;
+
+    ListFunction() : Object(kType) {
+    }
+    virtual ~ListFunction() override = default;
+    virtual std::string ToString() override {
+        return "can't print a function\n";
+    }
+    virtual std::shared_ptr<Object> Apply(SymbolId func, Arguments args) override {
+        return ApplyListFunction(func, args);
+    }
+};
+
+// (runtime-stats), see MakeStatsList.
+struct StatsFunction : public Object {
+public:
+    static constexpr ObjectType kType = ObjectType::STATS_FUNCTION;
+
+    StatsFunction() : Object(kType) {
+    }
+    virtual ~StatsFunction() override = default;
+    virtual std::string ToString() override {
+        return "can't print a function\n";
+    }
+    virtual std::shared_ptr<Object> Apply(SymbolId, Arguments args) override {
+        if (!args.empty()) {
+            throw RuntimeError("runtime-stats takes no arguments\n");
+        }
+        return MakeStatsList();
+    }
+};
@@ -1,142 +1,344 @@
 #include <parser.h>
 
-std::shared_ptr<Object> Read(Tokenizer* tokenizer) {
+#include <vector>
 
-    if (tokenizer->IsEnd()) {
-        throw SyntaxError("");
+namespace {
+
+// What an unfinished read is waiting for.
+enum class ReadState {
+    LIST_ELEMENT,  // the next element of a list
+    DOTTED_TAIL,   // the datum after a dot
+    QUOTED,        // the datum after a quote
+};
+
+// One datum whose read has started but not finished. Nested data push these on an explicit
+// stack instead of recursing, so the nesting depth of the input is only limited by memory.
+struct PendingRead {
+    ReadState state;
+    // the list is only built once it is complete, so that its cells make a single run
+    std::vector<std::shared_ptr<Object>> elements = {};
+    std::shared_ptr<Object> tail = nullptr;
+    size_t size = 0;
+    size_t cnt_open = 0;
+    // where the open bracket or the quote is
+    uint32_t begin = 0;
+};
+
+// What the reader should do after a step of a list read.
+enum class ReadStep {
+    READ_DATUM,    // read a nested datum and hand it to the top pending read
+    NEXT_ELEMENT,  // look at the token after the last element of the top list
+    FINISHED,      // the top list is complete
+};
+
+bool IsCloseBracket(const Token& token) {
+    const BracketToken* bracket_token = std::get_if<BracketToken>(&token);
+    return bracket_token && *bracket_token == BracketToken::CLOSE;
+}
+
+std::shared_ptr<Object> MakeReadList(PendingRead* read) {
+    return MakeList(read->elements, std::move(read->tail));
+}
+
+// Continues a list after an element has been read, `object` is that element. `()` reads as
+// nothing, in which case the next datum is tried instead.
+ReadStep ContinueElement(PendingRead* read, Tokenizer* tokenizer, std::shared_ptr<Object> object,
+                         std::shared_ptr<Object>* result) {
+    bool is_closed = false;
+    if (!object && !tokenizer->IsEnd()) {
+        ++read->size;
+        if (!IsCloseBracket(tokenizer->GetToken())) {
+            read->state = ReadState::LIST_ELEMENT;
+            return ReadStep::READ_DATUM;
+        }
+        is_closed = true;
+    }
+    if (object && !is_closed) {
+        ++read->size;
+        read->elements.back() = std::move(object);
+    } else if (!is_closed) {
+        if (!read->cnt_open) {
+            *result = MakeReadList(read);
+            return ReadStep::FINISHED;
+        }
+        throw SyntaxError("an expression has not closed bracket to open bracket\n");
+    } else if (!read->cnt_open) {
+        throw SyntaxError("an expression has not open bracket to close bracket\n");
     }
 
+    if (tokenizer->IsEnd() && read->cnt_open) {
+        throw SyntaxError("an expression has not close bracket to some open bracket\n");
+    }
     Token token = tokenizer->GetToken();
-    tokenizer->Next();
-    size_t cnt_open = 0;
-    BracketToken* bracket_token = std::get_if<BracketToken>(&token);
-    if (bracket_token && *bracket_token == BracketToken::OPEN) {
-        ++cnt_open;
-        std::shared_ptr<Cell> cell = std::make_shared<Cell>();
-        std::shared_ptr<Cell> curr_cell(cell);
-        size_t size = 0;
-        while (!tokenizer->IsEnd()) {
-            token = tokenizer->GetToken();
-            DotToken* dot_token = std::get_if<DotToken>(&token);
-            if (dot_token) {
-                throw SyntaxError("dot can't be after open scope\n");
-            }
-            bracket_token = std::get_if<BracketToken>(&token);
-            if (bracket_token && *bracket_token == BracketToken::CLOSE) {
-                if (cnt_open) {
-                    --cnt_open;
-                } else {
-                    throw SyntaxError("");
-                }
-                if (size == 0) {
-                    tokenizer->Next();
-                    if (!cnt_open) {
-                        return nullptr;
-                    }
-                    throw SyntaxError("");
-                }
-                break;
+    if (IsCloseBracket(token)) {
+        if (read->cnt_open) {
+            --read->cnt_open;
+        } else {
+            throw SyntaxError("");
+        }
+        tokenizer->Next();
+        if (!read->cnt_open) {
+            *result = MakeReadList(read);
+            return ReadStep::FINISHED;
+        }
+        throw SyntaxError("");
+    }
+
+    if (std::get_if<DotToken>(&token)) {
+        tokenizer->Next();
+        if (tokenizer->IsEnd()) {
+            throw SyntaxError("an expression ends with a dot\n");
+        }
+        if (IsCloseBracket(tokenizer->GetToken())) {
+            throw SyntaxError("an expression has not argument between dot and close bracket\n");
+        }
+        read->state = ReadState::DOTTED_TAIL;
+        return ReadStep::READ_DATUM;
+    }
+
+    read->elements.emplace_back();
+    return ReadStep::NEXT_ELEMENT;
+}
+
+// Decides whether a list ends before its next element.
+ReadStep StartElement(PendingRead* read, Tokenizer* tokenizer, std::shared_ptr<Object>* result) {
+    if (!tokenizer->IsEnd()) {
+        Token token = tokenizer->GetToken();
+        if (std::get_if<DotToken>(&token)) {
+            throw SyntaxError("dot can't be after open scope\n");
+        }
+        if (!IsCloseBracket(token)) {
+            return ContinueElement(read, tokenizer, nullptr, result);
+        }
+        if (read->cnt_open) {
+            --read->cnt_open;
+        } else {
+            throw SyntaxError("");
+        }
+        if (read->size == 0) {
+            tokenizer->Next();
+            if (!read->cnt_open) {
+                *result = nullptr;
+                return ReadStep::FINISHED;
             }
+            throw SyntaxError("");
+        }
+    }
+    if (!read->cnt_open) {
+        *result = MakeReadList(read);
+        return ReadStep::FINISHED;
+    }
+    throw SyntaxError("");
+}
 
-            bool is_closed = false;
-            std::shared_ptr<Object> object = nullptr;
-            while (!object && !tokenizer->IsEnd()) {
-                ++size;
-                token = tokenizer->GetToken();
-                bracket_token = std::get_if<BracketToken>(&token);
-                if (bracket_token && *bracket_token == BracketToken::CLOSE) {
-                    is_closed = true;
-                    break;
-                }
-                object = Read(tokenizer);
+// Finishes a dotted list, `tail` is the datum after the dot.
+ReadStep FinishTail(PendingRead* read, Tokenizer* tokenizer, std::shared_ptr<Object> tail,
+                    std::shared_ptr<Object>* result) {
+    read->tail = std::move(tail);
+    if (tokenizer->IsEnd()) {
+        throw SyntaxError("an expression has not close bracket for some open bracket\n");
+    }
+    if (!IsCloseBracket(tokenizer->GetToken())) {
+        throw SyntaxError("an expression has vide of pair, but it is not pair\n");
+    }
+    tokenizer->Next();
+    if (read->cnt_open == 1) {
+        *result = MakeReadList(read);
+        return ReadStep::FINISHED;
+    }
+    throw SyntaxError("an expression has not close bracket for some open bracket\n");
+}
+
+std::shared_ptr<Object> ReadAtom(const Token& token) {
+    if (const SymbolToken* symbol_token = std::get_if<SymbolToken>(&token)) {
+        return New<Symbol>(symbol_token->id);
+    }
+    if (const ConstantToken* constant_token = std::get_if<ConstantToken>(&token)) {
+        if (constant_token->big) {
+            return New<Number>(*constant_token->big);
+        }
+        return MakeNumber(constant_token->value);
+    }
+    if (std::get_if<DotToken>(&token)) {
+        return New<Dot>();
+    }
+    return nullptr;
+}
+
+// The elements of #(...) after its opening token, up to and including the close bracket. They
+// can only be integers, so there is nothing nested to keep track of.
+std::shared_ptr<Object> ReadVector(Tokenizer* tokenizer) {
+    std::vector<int64_t> elements;
+    while (!tokenizer->IsEnd() && !IsCloseBracket(tokenizer->GetToken())) {
+        Token token = tokenizer->GetToken();
+        const ConstantToken* constant_token = std::get_if<ConstantToken>(&token);
+        if (!constant_token || constant_token->big) {
+            throw SyntaxError("a vector literal can only hold 64-bit integers\n");
+        }
+        elements.push_back(constant_token->value);
+        tokenizer->Next();
+    }
+    if (tokenizer->IsEnd()) {
+        throw SyntaxError("a vector literal has not close bracket\n");
+    }
+    tokenizer->Next();
+    return New<NumericVector>(std::move(elements));
+}
+
+}  // namespace
+
+std::shared_ptr<Object> Read(Tokenizer* tokenizer, SourceMap* spans) {
+    std::vector<PendingRead> pending;
+    std::shared_ptr<Object> datum;
+    ReadStep step = ReadStep::READ_DATUM;
+    while (true) {
+        if (step == ReadStep::READ_DATUM) {
+            if (tokenizer->IsEnd()) {
+                throw SyntaxError("");
             }
-            if (object && !is_closed) {
-                ++size;
-                curr_cell->SetFirst(object);
-            } else if (!is_closed) {
-                if (!cnt_open) {
-                    return cell;
-                }
-                throw SyntaxError("an expression has not closed bracket to open bracket\n");
-            } else if (!cnt_open) {
-                throw SyntaxError("an expression has not open bracket to close bracket\n");
+            Token token = tokenizer->GetToken();
+            uint32_t begin = tokenizer->GetSpan().begin;
+            tokenizer->Next();
+            BracketToken* bracket_token = std::get_if<BracketToken>(&token);
+            if (bracket_token && *bracket_token == BracketToken::OPEN) {
+                pending.push_back({ReadState::LIST_ELEMENT, {nullptr}, nullptr, 0, 1, begin});
+                step = StartElement(&pending.back(), tokenizer, &datum);
+            } else if (bracket_token && *bracket_token == BracketToken::VECTOR_OPEN) {
+                datum = ReadVector(tokenizer);
+                step = ReadStep::FINISHED;
+                continue;
+            } else if (std::get_if<QuoteToken>(&token)) {
+                pending.push_back({ReadState::QUOTED, {}, nullptr, 0, 0, begin});
+                continue;
+            } else {
+                datum = ReadAtom(token);
+                step = ReadStep::FINISHED;
+                continue;
             }
-
-            if (tokenizer->IsEnd() && cnt_open) {
-                throw SyntaxError("an expression has not close bracket to some open bracket\n");
+        } else if (step == ReadStep::NEXT_ELEMENT) {
+            step = StartElement(&pending.back(), tokenizer, &datum);
+        } else {
+            // `datum` is complete, hand it to the read waiting for it
+            if (pending.empty()) {
+                return datum;
             }
-            token = tokenizer->GetToken();
-            bracket_token = std::get_if<BracketToken>(&token);
-            if (bracket_token && *bracket_token == BracketToken::CLOSE) {
-                if (cnt_open) {
-                    --cnt_open;
-                } else {
-                    throw SyntaxError("");
+            PendingRead* read = &pending.back();
+            if (read->state == ReadState::QUOTED) {
+                datum = New<Cell>(New<Symbol>(QUOTE), New<Cell>(std::move(datum)));
+                if (spans) {
+                    spans->Add(datum.get(), {read->begin, tokenizer->GetConsumedEnd()});
                 }
-                tokenizer->Next();
-                if (!cnt_open) {
-                    return cell;
-                }
-                throw SyntaxError("");
+                pending.pop_back();
+                continue;
             }
-
-            dot_token = std::get_if<DotToken>(&token);
-            if (dot_token) {
-                tokenizer->Next();
-                if (tokenizer->IsEnd()) {
-                    throw SyntaxError("an expression ends with a dot\n");
-                }
-                token = tokenizer->GetToken();
-                bracket_token = std::get_if<BracketToken>(&token);
-                if (bracket_token && *bracket_token == BracketToken::CLOSE) {
-                    throw SyntaxError(
-                        "an expression has not argument between dot and close bracket\n");
-                }
-                curr_cell->SetSecond(Read(tokenizer));
-                if (tokenizer->IsEnd()) {
-                    throw SyntaxError(
-                        "an expression has not close bracket for some open bracket\n");
-                }
-                token = tokenizer->GetToken();
-                bracket_token = std::get_if<BracketToken>(&token);
-                if (!bracket_token || *bracket_token != BracketToken::CLOSE) {
-                    throw SyntaxError("an expression has vide of pair, but it is not pair\n");
-                }
-                tokenizer->Next();
-                if (cnt_open == 1) {
-                    return cell;
-                }
-                throw SyntaxError("an expression has not close bracket for some open bracket\n");
+            if (read->state == ReadState::LIST_ELEMENT) {
+                step = ContinueElement(read, tokenizer, std::move(datum), &datum);
+            } else {
+                step = FinishTail(read, tokenizer, std::move(datum), &datum);
             }
-
-            curr_cell->SetSecond(std::make_shared<Cell>());
-            curr_cell = As<Cell>(curr_cell->GetSecond());
         }
-        if (!cnt_open) {
-            return cell;
+        if (step == ReadStep::FINISHED) {
+            // the top list is complete, `datum` is the list itself
+            if (spans && datum) {
+                spans->Add(datum.get(), {pending.back().begin, tokenizer->GetConsumedEnd()});
+            }
+            pending.pop_back();
         }
-        throw SyntaxError("");
     }
+}
 
-    SymbolToken* symbol_token = std::get_if<SymbolToken>(&token);
-    if (symbol_token) {
-        return std::make_shared<Symbol>(symbol_token->name);
-    }
+namespace {
 
-    ConstantToken* constant_token = std::get_if<ConstantToken>(&token);
-    if (constant_token) {
-        return std::make_shared<Number>(constant_token->value);
-    }
+bool IsAtomChar(char c) {
+    return c != '(' && c != ')' && c != '\'' &&
+           HasClass(static_cast<unsigned char>(c),
+                    DIGIT_CHAR | SYMBOL_START_CHAR | SYMBOL_INTERNAL_CHAR | PUNCTUATION_CHAR);
+}
 
-    DotToken* dot_token = std::get_if<DotToken>(&token);
-    if (dot_token) {
-        return std::make_shared<Dot>();
+}  // namespace
+
+template <class EndForm>
+size_t FormReader::Scan(std::string_view chunk, EndForm&& end_form) {
+    // where the form in progress starts within chunk
+    size_t begin = 0;
+    auto finish_form = [&](size_t end) {
+        end_form(begin, end);
+        is_in_form_ = false;
+        is_in_atom_ = false;
+        is_hash_ = false;
+    };
+    for (size_t i = 0; i < chunk.size(); ++i) {
+        char c = chunk[i];
+        if (depth_) {
+            // nested data needs nothing but the brackets counted
+            if (c == '(') {
+                ++depth_;
+            } else if (c == ')' && !--depth_) {
+                finish_form(i + 1);
+            }
+            continue;
+        }
+        if (is_in_atom_) {
+            if (c == '(' && is_hash_) {
+                is_in_atom_ = false;
+                depth_ = 1;
+                continue;
+            }
+            if (IsAtomChar(c)) {
+                is_hash_ = false;
+                continue;
+            }
+            finish_form(i);
+        }
+        if (c != '(' && c != ')' && c != '\'' && !IsAtomChar(c)) {
+            continue;
+        }
+        if (!is_in_form_) {
+            is_in_form_ = true;
+            begin = i;
+        }
+        if (c == '(') {
+            depth_ = 1;
+        } else if (c == ')') {
+            // an unbalanced bracket, a form of its own which Read rejects
+            finish_form(i + 1);
+        } else if (c != '\'') {
+            // quotes only prefix the datum after them
+            is_in_atom_ = true;
+            is_hash_ = c == '#';
+        }
     }
+    return is_in_form_ ? begin : chunk.size();
+}
+
+void FormReader::Feed(std::string_view chunk, std::vector<std::string>* forms) {
+    size_t rest = Scan(chunk, [&](size_t begin, size_t end) {
+        buffer_.append(chunk.substr(begin, end - begin));
+        forms->push_back(std::move(buffer_));
+        buffer_.clear();
+    });
+    buffer_.append(chunk.substr(rest));
+}
 
-    QuoteToken* quote_token = std::get_if<QuoteToken>(&token);
-    if (quote_token) {
-        return std::make_shared<Cell>(std::make_shared<Symbol>("quote"), Read(tokenizer));
+void FormReader::Finish(std::vector<std::string>* forms) {
+    if (is_in_form_) {
+        forms->push_back(std::move(buffer_));
+        buffer_.clear();
     }
+    is_in_form_ = false;
+    is_in_atom_ = false;
+    is_hash_ = false;
+    depth_ = 0;
+}
 
-    return nullptr;
-}
\ No newline at end of file
+std::vector<std::string_view> FormReader::Split(std::string_view text) {
+    FormReader reader;
+    std::vector<std::string_view> forms;
+    size_t rest = reader.Scan(text, [&](size_t begin, size_t end) {
+        forms.push_back(text.substr(begin, end - begin));
+    });
+    if (rest < text.size()) {
+        forms.push_back(text.substr(rest));
+    }
+    return forms;
+}
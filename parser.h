@@ -2,9 +2,47 @@
 
 #include <queue>
 #include <map>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "error.h"
 #include "object.h"
 #include "tokenizer.h"
 
-std::shared_ptr<Object> Read(Tokenizer* tokenizer);
\ No newline at end of file
+// With spans, the span of every list and quote form read is added to it, keyed by its first cell.
+std::shared_ptr<Object> Read(Tokenizer* tokenizer, SourceMap* spans = nullptr);
+// Push-style front end of Read for input which arrives in pieces, e.g. from a pipe: chunks of any
+// size, split anywhere, go in, and every top-level form comes out as text as soon as its last byte
+// is in, ready for Read. Only the form in progress is kept, whatever separates forms is dropped,
+// so memory follows the largest form rather than the stream.
+class FormReader {
+public:
+    // Adds the forms completed by chunk to forms, in order.
+    void Feed(std::string_view chunk, std::vector<std::string>* forms);
+    // The end of input: the form in progress, complete or not, becomes the last one, for Read to
+    // report what is missing.
+    void Finish(std::vector<std::string>* forms);
+    // The forms of a complete text, as views into it: nothing is copied.
+    static std::vector<std::string_view> Split(std::string_view text);
+
+    size_t GetBufferedBytes() const {
+        return buffer_.size();
+    }
+
+private:
+    // Calls end_form(begin, end) with the bounds within chunk of every form chunk completes.
+    // Returns where the form left in progress starts within chunk, chunk.size() if there is none.
+    template <class EndForm>
+    size_t Scan(std::string_view chunk, EndForm&& end_form);
+
+    // the part of the form in progress from earlier chunks
+    std::string buffer_;
+    bool is_in_form_ = false;
+    // open brackets of the form in progress
+    size_t depth_ = 0;
+    // a top-level atom is in progress; it ends at the first byte which can't continue it
+    bool is_in_atom_ = false;
+    // the atom so far is "#", which starts a vector if "(" follows
+    bool is_hash_ = false;
+};
@@ -0,0 +1,55 @@
+#include <printer.h>
+
+#include <vector>
+
+namespace {
+
+void PrintAtom(Object* object, std::string* output) {
+    if (!object) {
+        output->append("()");
+    } else if (Is<Symbol>(object)) {
+        output->append(SymbolName(static_cast<Symbol*>(object)->GetId()));
+    } else {
+        output->append(object->ToString());
+    }
+}
+
+}  // namespace
+
+void Print(Object* object, std::string* output) {
+    // for every list being printed, what follows the element being printed
+    std::vector<Object*> rests;
+    while (true) {
+        if (Is<Cell>(object)) {
+            Cell* cell = static_cast<Cell*>(object);
+            output->push_back('(');
+            rests.push_back(cell->ViewSecond());
+            object = cell->ViewFirst();
+            continue;
+        }
+        PrintAtom(object, output);
+
+        // close the lists which have ended, then go on with the next element
+        while (!rests.empty() && !Is<Cell>(rests.back())) {
+            if (rests.back()) {
+                output->append(" . ");
+                PrintAtom(rests.back(), output);
+            }
+            output->push_back(')');
+            rests.pop_back();
+        }
+        if (rests.empty()) {
+            return;
+        }
+        Cell* next = static_cast<Cell*>(rests.back());
+        output->push_back(' ');
+        rests.back() = next->ViewSecond();
+        object = next->ViewFirst();
+    }
+}
+
+std::string Print(const std::shared_ptr<Object>& object) {
+    std::string output;
+    Print(object.get(), &output);
+    return output;
+}
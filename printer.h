@@ -0,0 +1,13 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "object.h"
+
+// Appends the written form of `object` to `output`. Lists are walked in a loop with an explicit
+// stack, so printing is linear in the size of the result and doesn't depend on its depth.
+// nullptr is the empty list.
+void Print(Object* object, std::string* output);
+
+std::string Print(const std::shared_ptr<Object>& object);
@@ -0,0 +1,80 @@
+#include "profiler.h"
+
+thread_local ProfileScope* ProfileScope::current_ = nullptr;
+
+Profiler::Profiler(std::chrono::microseconds interval) : interval_{interval} {
+    ticker_ = std::thread([this] {
+        std::unique_lock lock(ticker_mutex_);
+        while (!ticker_stop_.wait_for(lock, interval_, [this] { return is_stopped_; })) {
+            ticks_.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+}
+
+Profiler::~Profiler() {
+    Stop();
+}
+
+void Profiler::Stop() {
+    {
+        std::lock_guard lock(ticker_mutex_);
+        is_stopped_ = true;
+    }
+    ticker_stop_.notify_one();
+    if (ticker_.joinable()) {
+        ticker_.join();
+    }
+}
+
+void Profiler::Record(const std::vector<ProfileFrame>& frames, uint64_t ticks) {
+    std::string stack;
+    for (const ProfileFrame& frame : frames) {
+        if (!stack.empty()) {
+            stack += ';';
+        }
+        stack += frame.source_map->Describe(frame.span);
+    }
+    if (stack.empty()) {
+        // nothing being evaluated was read from a source
+        stack = "[unknown]";
+    }
+    std::lock_guard lock(stacks_mutex_);
+    stacks_[stack] += ticks;
+    sampled_ticks_ += ticks;
+}
+
+uint64_t Profiler::GetSampledTicks() const {
+    std::lock_guard lock(stacks_mutex_);
+    return sampled_ticks_;
+}
+
+std::string Profiler::GetFoldedStacks() const {
+    std::lock_guard lock(stacks_mutex_);
+    std::string output;
+    for (const auto& [stack, ticks] : stacks_) {
+        output += stack + ' ' + std::to_string(ticks) + '\n';
+    }
+    return output;
+}
+
+ProfileScope::ProfileScope(Profiler* profiler, const SourceMap* source_map)
+    : profiler_{profiler}, source_map_{source_map} {
+    if (!profiler_) {
+        return;
+    }
+    seen_ticks_ = profiler_->GetTicks();
+    previous_ = current_;
+    current_ = this;
+}
+
+ProfileScope::~ProfileScope() {
+    if (profiler_) {
+        current_ = previous_;
+    }
+}
+
+void ProfileScope::Sample(const std::vector<ProfileFrame>& frames) {
+    uint64_t ticks = profiler_->GetTicks();
+    profiler_->Record(frames, ticks - seen_ticks_);
+    seen_ticks_ = ticks;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "source_map.h"
+
+const std::chrono::microseconds kDefaultProfileInterval{1000};
+
+// One expression being evaluated, as the profiler sees it.
+struct ProfileFrame {
+    const SourceMap* source_map;
+    SourceSpan span;
+};
+
+// Sampling profiler: a thread ticks every interval, and evaluators attached with a ProfileScope
+// check for new ticks at their safe points, i.e. between steps. The ticks are charged to the
+// expressions being evaluated at that moment, so a step which takes long, like a builtin over a
+// big list, is charged in full to the expressions around it.
+class Profiler {
+public:
+    explicit Profiler(std::chrono::microseconds interval = kDefaultProfileInterval);
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+    ~Profiler();
+
+    // Stops the ticks; what has been sampled so far stays.
+    void Stop();
+
+    uint64_t GetTicks() const {
+        return ticks_.load(std::memory_order_relaxed);
+    }
+    // Charges ticks to a stack of frames, outermost first.
+    void Record(const std::vector<ProfileFrame>& frames, uint64_t ticks);
+
+    std::chrono::microseconds GetInterval() const {
+        return interval_;
+    }
+    uint64_t GetSampledTicks() const;
+    // One line per stack, frames separated by semicolons and followed by its ticks, the folded
+    // format flamegraph.pl and compatible tools read.
+    std::string GetFoldedStacks() const;
+
+private:
+    std::chrono::microseconds interval_;
+    std::atomic<uint64_t> ticks_ = 0;
+
+    std::mutex ticker_mutex_;
+    std::condition_variable ticker_stop_;
+    bool is_stopped_ = false;
+    std::thread ticker_;
+
+    mutable std::mutex stacks_mutex_;
+    std::map<std::string, uint64_t> stacks_;
+    uint64_t sampled_ticks_ = 0;
+};
+
+// Attaches the evaluators running on the calling thread to a profiler for the lifetime of the
+// scope. Without a profiler nothing is attached, and evaluators don't look for ticks at all.
+class ProfileScope {
+public:
+    // `source_map` is where the tree being evaluated by Calc was read from, if anywhere.
+    ProfileScope(Profiler* profiler, const SourceMap* source_map);
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+    ~ProfileScope();
+
+    static ProfileScope* Current() {
+        return current_;
+    }
+
+    const SourceMap* GetSourceMap() const {
+        return source_map_;
+    }
+    bool IsSampleDue() const {
+        return profiler_->GetTicks() != seen_ticks_;
+    }
+    // Charges the ticks since the last sample to frames. Ticks after the last safe point of the
+    // scope are not charged to anything.
+    void Sample(const std::vector<ProfileFrame>& frames);
+
+private:
+    Profiler* profiler_;
+    const SourceMap* source_map_;
+    uint64_t seen_ticks_ = 0;
+    ProfileScope* previous_ = nullptr;
+
+    static thread_local ProfileScope* current_;
+};
@@ -0,0 +1,121 @@
+#include <result_cache.h>
+
+namespace {
+
+bool IsQuoteHead(Object* head) {
+    return Is<Symbol>(head) && static_cast<Symbol*>(head)->GetId() == QUOTE;
+}
+
+}  // namespace
+
+bool IsCacheable(const std::shared_ptr<Object>& ast) {
+    // walked with an explicit stack, expressions may be nested arbitrarily deep
+    std::vector<Object*> pending = {ast.get()};
+    while (!pending.empty()) {
+        Object* object = pending.back();
+        pending.pop_back();
+        if (Is<Cell>(object)) {
+            Cell* cell = static_cast<Cell*>(object);
+            if (!IsQuoteHead(cell->ViewFirst())) {
+                pending.push_back(cell->ViewFirst());
+                pending.push_back(cell->ViewSecond());
+            }
+        } else if (Is<Symbol>(object)) {
+            SymbolId id = static_cast<Symbol*>(object)->GetId();
+            if ((!IsBuiltinFunction(id) || id == RUNTIME_STATS) && id != TRUE_LITERAL &&
+                id != FALSE_LITERAL) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void ResultCache::SetLimits(ResultCacheLimits limits) {
+    limits_ = limits;
+    if (!IsEnabled()) {
+        stats_.evictions += entries_.size();
+        stats_.bytes = 0;
+        entries_.clear();
+        by_key_.clear();
+        by_source_.clear();
+        return;
+    }
+    EvictOverLimits();
+}
+
+const std::string* ResultCache::FindSource(const std::string& source) {
+    auto it = by_source_.find(source);
+    if (it == by_source_.end()) {
+        return nullptr;
+    }
+    ++stats_.hits;
+    Touch(it->second);
+    return &it->second->output;
+}
+
+const std::string* ResultCache::Find(const std::string& key, const std::string& source) {
+    auto it = by_key_.find(key);
+    if (it == by_key_.end()) {
+        ++stats_.misses;
+        return nullptr;
+    }
+    ++stats_.hits;
+    EntryList::iterator entry = it->second;
+    Touch(entry);
+    AddSource(entry, source);
+    // the new source may have pushed the cache over its limits, the entry itself stays
+    EvictOverLimits();
+    return &entry->output;
+}
+
+void ResultCache::Insert(const std::string& key, const std::string& source,
+                         const std::string& output) {
+    if (!IsEnabled() || by_key_.count(key)) {
+        return;
+    }
+    size_t bytes = key.size() + output.size();
+    if (bytes + source.size() > limits_.max_bytes) {
+        return;
+    }
+    entries_.push_front({output, nullptr, {}, bytes});
+    auto [it, inserted] = by_key_.emplace(key, entries_.begin());
+    entries_.front().key = &it->first;
+    stats_.bytes += bytes;
+    AddSource(entries_.begin(), source);
+    EvictOverLimits();
+}
+
+ResultCacheStats ResultCache::GetStats() const {
+    ResultCacheStats stats = stats_;
+    stats.entries = entries_.size();
+    return stats;
+}
+
+void ResultCache::Touch(EntryList::iterator entry) {
+    entries_.splice(entries_.begin(), entries_, entry);
+}
+
+void ResultCache::AddSource(EntryList::iterator entry, const std::string& source) {
+    auto [it, inserted] = by_source_.emplace(source, entry);
+    if (inserted) {
+        entry->sources.push_back(&it->first);
+        entry->bytes += source.size();
+        stats_.bytes += source.size();
+    }
+}
+
+void ResultCache::EvictOverLimits() {
+    // the most recently used entry is kept, Find has handed out a pointer into it
+    while (entries_.size() > 1 &&
+           (entries_.size() > limits_.max_entries || stats_.bytes > limits_.max_bytes)) {
+        Entry& entry = entries_.back();
+        for (const std::string* source : entry.sources) {
+            by_source_.erase(by_source_.find(*source));
+        }
+        stats_.bytes -= entry.bytes;
+        by_key_.erase(by_key_.find(*entry.key));
+        entries_.pop_back();
+        ++stats_.evictions;
+    }
+}
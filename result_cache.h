@@ -0,0 +1,69 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "object.h"
+
+// Bounds of a result cache. With either of them zero nothing is cached.
+struct ResultCacheLimits {
+    size_t max_entries = 0;
+    size_t max_bytes = 0;  // of the texts held: canonical forms, sources and outputs
+};
+
+struct ResultCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;  // cacheable expressions which had to be evaluated
+    size_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+// Whether the value of ast depends on nothing but ast: outside of quoted data it only names
+// builtin functions other than runtime-stats, none of which has a side effect, and no variable or
+// special form.
+bool IsCacheable(const std::shared_ptr<Object>& ast);
+
+// Outputs of expressions, the least recently used dropped first. An entry is keyed by the
+// canonical written form of the parsed expression, so texts which differ only in spacing or in
+// 'x versus (quote x) share it. Every text an entry was read from is remembered too, which lets
+// a verbatim repeat be answered before it is even tokenized.
+class ResultCache {
+public:
+    void SetLimits(ResultCacheLimits limits);
+    bool IsEnabled() const {
+        return limits_.max_entries > 0 && limits_.max_bytes > 0;
+    }
+
+    // The output for a text seen before, nullptr otherwise.
+    const std::string* FindSource(const std::string& source);
+    // The output for a canonical form; on a hit `source` is remembered as one more text of it.
+    const std::string* Find(const std::string& key, const std::string& source);
+    void Insert(const std::string& key, const std::string& source, const std::string& output);
+
+    ResultCacheStats GetStats() const;
+
+private:
+    struct Entry {
+        std::string output;
+        const std::string* key;
+        // keys of by_source_, nodes of an unordered_map don't move
+        std::vector<const std::string*> sources;
+        size_t bytes;
+    };
+    using EntryList = std::list<Entry>;
+
+    void Touch(EntryList::iterator entry);
+    void AddSource(EntryList::iterator entry, const std::string& source);
+    void EvictOverLimits();
+
+    ResultCacheLimits limits_;
+    ResultCacheStats stats_;
+    // most recently used first
+    EntryList entries_;
+    std::unordered_map<std::string, EntryList::iterator> by_key_;
+    std::unordered_map<std::string, EntryList::iterator> by_source_;
+};
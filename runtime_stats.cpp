@@ -0,0 +1,143 @@
+#include "runtime_stats.h"
+
+#include <string>
+#include <vector>
+
+#include "object.h"
+
+thread_local RuntimeStats* StatsScope::current_ = nullptr;
+thread_local StatsScope* StatsScope::current_scope_ = nullptr;
+
+namespace {
+
+const char* const kPhaseNames[kPhaseCount] = {"read", "fold", "compile", "evaluate", "print"};
+
+const char* const kObjectTypeNames[kObjectTypeCount] = {
+    "dot", "number", "symbol", "cell", "nullptr", "boolean", "numeric-vector",
+    "unary-bool-function", "binary-bool-function", "binary-integer-function",
+    "unary-integer-function", "only-unary-bool-function", "non-type-binary-bool-function",
+    "constructor-function", "getter-function", "vector-function", "list-function",
+    "stats-function", "closure"};
+
+TimedCount& operator+=(TimedCount& lhs, const TimedCount& rhs) {
+    lhs.count += rhs.count;
+    lhs.time += rhs.time;
+    return lhs;
+}
+
+std::shared_ptr<Object> MakeEntry(std::shared_ptr<Object> name, size_t count, size_t amount) {
+    std::shared_ptr<Object> entry[] = {std::move(name), MakeNumber(static_cast<int64_t>(count)),
+                                       MakeNumber(static_cast<int64_t>(amount))};
+    return MakeList(entry);
+}
+
+std::shared_ptr<Object> MakeEntry(std::shared_ptr<Object> name, const TimedCount& counter) {
+    return MakeEntry(std::move(name), counter.count, counter.time.count());
+}
+
+// (name entry ...), or nothing but the name if there are no entries.
+std::shared_ptr<Object> MakeSection(const char* name,
+                                    std::vector<std::shared_ptr<Object>> entries) {
+    entries.insert(entries.begin(), New<Symbol>(name));
+    return MakeList(entries);
+}
+
+}  // namespace
+
+RuntimeStats& RuntimeStats::operator+=(const RuntimeStats& other) {
+    runs += other.runs;
+    for (size_t i = 0; i < kPhaseCount; ++i) {
+        phases[i] += other.phases[i];
+    }
+    for (size_t i = 0; i < FUNCTION_COUNT; ++i) {
+        builtins[i] += other.builtins[i];
+    }
+    for (size_t i = 0; i < kObjectTypeCount; ++i) {
+        allocations[i].count += other.allocations[i].count;
+        allocations[i].bytes += other.allocations[i].bytes;
+    }
+    return *this;
+}
+
+const char* PhaseName(Phase phase) {
+    return kPhaseNames[static_cast<size_t>(phase)];
+}
+
+const char* ObjectTypeName(ObjectType type) {
+    return kObjectTypeNames[static_cast<size_t>(type)];
+}
+
+void SharedStats::Add(const RuntimeStats& stats) {
+    std::lock_guard lock(mutex_);
+    stats_ += stats;
+}
+
+RuntimeStats SharedStats::Get() const {
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+StatsScope::StatsScope(SharedStats* totals) : totals_{totals} {
+    if (!totals_) {
+        return;
+    }
+    stats_.emplace().runs = 1;
+    previous_ = current_;
+    previous_scope_ = current_scope_;
+    current_ = &*stats_;
+    current_scope_ = this;
+}
+
+StatsScope::~StatsScope() {
+    if (!totals_) {
+        return;
+    }
+    current_ = previous_;
+    current_scope_ = previous_scope_;
+    totals_->Add(*stats_);
+}
+
+std::optional<RuntimeStats> StatsScope::Snapshot() {
+    if (!current_scope_) {
+        return std::nullopt;
+    }
+    RuntimeStats stats = current_scope_->totals_->Get();
+    stats += *current_scope_->stats_;
+    return stats;
+}
+
+std::shared_ptr<Object> MakeStatsList() {
+    std::optional<RuntimeStats> stats = StatsScope::Snapshot();
+    if (!stats) {
+        throw RuntimeError("runtime statistics are disabled\n");
+    }
+
+    std::vector<std::shared_ptr<Object>> phases;
+    for (size_t i = 0; i < kPhaseCount; ++i) {
+        if (stats->phases[i].count) {
+            phases.push_back(MakeEntry(New<Symbol>(kPhaseNames[i]), stats->phases[i]));
+        }
+    }
+    std::vector<std::shared_ptr<Object>> builtins;
+    for (SymbolId id = 0; id < FUNCTION_COUNT; ++id) {
+        if (stats->builtins[id].count) {
+            builtins.push_back(MakeEntry(New<Symbol>(id), stats->builtins[id]));
+        }
+    }
+    std::vector<std::shared_ptr<Object>> allocations;
+    for (size_t i = 0; i < kObjectTypeCount; ++i) {
+        if (stats->allocations[i].count) {
+            allocations.push_back(MakeEntry(New<Symbol>(kObjectTypeNames[i]),
+                                            stats->allocations[i].count,
+                                            stats->allocations[i].bytes));
+        }
+    }
+
+    std::shared_ptr<Object> runs[] = {New<Symbol>("runs"),
+                                      MakeNumber(static_cast<int64_t>(stats->runs))};
+    std::shared_ptr<Object> sections[] = {
+        MakeList(runs), MakeSection("phases", std::move(phases)),
+        MakeSection("builtins", std::move(builtins)),
+        MakeSection("allocations", std::move(allocations))};
+    return MakeList(sections);
+}
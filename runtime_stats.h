@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "symbol_table.h"
+
+class Object;
+enum class ObjectType : uint8_t;
+// The number of ObjectType values, checked where they are listed.
+const size_t kObjectTypeCount = 19;
+
+// Steps of a run whose wall time is measured.
+enum class Phase : uint8_t {
+    READ,      // tokenizing and Read together, Read pulls the tokens one at a time
+    FOLD,      // Fold
+    COMPILE,   // Compile, only with EvaluationMode::BYTECODE
+    EVALUATE,  // Calc or Execute
+    PRINT,     // Print of the result
+};
+const size_t kPhaseCount = 5;
+
+struct TimedCount {
+    size_t count = 0;
+    std::chrono::nanoseconds time{0};
+};
+
+struct AllocationCount {
+    size_t count = 0;
+    size_t bytes = 0;  // of the objects themselves, not of control blocks or what they own
+};
+
+// What runs did while statistics were collected.
+struct RuntimeStats {
+    // calls of Run, Prepare and Execute, and expressions of batches
+    size_t runs = 0;
+    // a builtin's time is also part of the phase which called it
+    std::array<TimedCount, kPhaseCount> phases{};
+    // calls through ApplyBuiltinFunction, by function id
+    std::array<TimedCount, FUNCTION_COUNT> builtins{};
+    // objects made by New and MakeList, by ObjectType; immortal ones are never counted
+    std::array<AllocationCount, kObjectTypeCount> allocations{};
+
+    RuntimeStats& operator+=(const RuntimeStats& other);
+};
+
+const char* PhaseName(Phase phase);
+const char* ObjectTypeName(ObjectType type);
+
+// Statistics of an interpreter. Each thread counts into a RuntimeStats of its own and adds it
+// here when its run is over, so counting needs no synchronization.
+class SharedStats {
+public:
+    void Add(const RuntimeStats& stats);
+    RuntimeStats Get() const;
+
+private:
+    mutable std::mutex mutex_;
+    RuntimeStats stats_;
+};
+
+// Collects what the calling thread does during its lifetime into a RuntimeStats which is added
+// to totals at the end. Without totals nothing is collected, and the instrumentation comes down
+// to one check of a thread-local pointer per allocation and per builtin call.
+class StatsScope {
+public:
+    explicit StatsScope(SharedStats* totals);
+    StatsScope(const StatsScope&) = delete;
+    StatsScope& operator=(const StatsScope&) = delete;
+    ~StatsScope();
+
+    // Counters of the calling thread, nullptr if nothing is collected.
+    static RuntimeStats* Current() {
+        return current_;
+    }
+    // Totals of the innermost scope of the calling thread, with what the scope has counted so
+    // far; nullptr if nothing is collected.
+    static std::optional<RuntimeStats> Snapshot();
+
+private:
+    SharedStats* totals_;
+    // only made when there are totals, a disabled scope has nothing to clear
+    std::optional<RuntimeStats> stats_;
+    RuntimeStats* previous_ = nullptr;
+    StatsScope* previous_scope_ = nullptr;
+
+    static thread_local RuntimeStats* current_;
+    static thread_local StatsScope* current_scope_;
+};
+
+// Adds one to a counter and the time until the end of the scope to its time; does nothing
+// without a counter.
+class ScopedTimer {
+public:
+    explicit ScopedTimer(TimedCount* counter) : counter_{counter} {
+        if (counter_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+    ~ScopedTimer() {
+        if (counter_) {
+            ++counter_->count;
+            counter_->time += std::chrono::steady_clock::now() - start_;
+        }
+    }
+
+private:
+    TimedCount* counter_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Counter of a phase of the current run, nullptr if nothing is collected.
+inline TimedCount* PhaseCounter(Phase phase) {
+    RuntimeStats* stats = StatsScope::Current();
+    return stats ? &stats->phases[static_cast<size_t>(phase)] : nullptr;
+}
+
+// Runs step, counting it towards phase.
+template <class Step>
+auto TimePhase(Phase phase, Step&& step) {
+    ScopedTimer timer(PhaseCounter(phase));
+    return step();
+}
+
+inline void CountAllocation(ObjectType type, size_t bytes, size_t count = 1) {
+    if (RuntimeStats* stats = StatsScope::Current()) {
+        AllocationCount& allocation = stats->allocations[static_cast<size_t>(type)];
+        allocation.count += count;
+        allocation.bytes += bytes * count;
+    }
+}
+
+// The value of (runtime-stats): an association list of the totals of the current scope, e.g.
+// ((runs 2) (phases (read 2 5310) ...) (builtins (+ 4 1250) ...) (allocations (cell 9 576) ...)),
+// times in nanoseconds. Phases, builtins and object types which were never counted are left out.
+std::shared_ptr<Object> MakeStatsList();
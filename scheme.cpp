@@ -1,103 +1,575 @@
 #include "scheme.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <deque>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 std::deque<int> a;
 
-std::map<std::string, std::shared_ptr<Object>> apply_function = {
-    {"quote", nullptr},
-    {"and", std::make_shared<NonTypeBinaryBoolFunction>()},
-    {"or", std::make_shared<NonTypeBinaryBoolFunction>()},
-    {"not", std::make_shared<OnlyUnaryBoolFunction>()},
-    {"boolean?", std::make_shared<UnaryBoolFunction>()},
-    {"number?", std::make_shared<UnaryBoolFunction>()},
-    {"pair?", std::make_shared<UnaryBoolFunction>()},
-    {"null?", std::make_shared<UnaryBoolFunction>()},
-    {"list?", std::make_shared<UnaryBoolFunction>()},
-    {"cons", std::make_shared<ConstructorFunction>()},
-    {"list", std::make_shared<ConstructorFunction>()},
-    {"car", std::make_shared<GetterFunction>()},
-    {"cdr", std::make_shared<GetterFunction>()},
-    {"list-ref", std::make_shared<GetterFunction>()},
-    {"list-tail", std::make_shared<GetterFunction>()},
-    {"=", std::make_shared<BinaryBoolFunction>()},
-    {"<", std::make_shared<BinaryBoolFunction>()},
-    {">", std::make_shared<BinaryBoolFunction>()},
-    {"<=", std::make_shared<BinaryBoolFunction>()},
-    {">=", std::make_shared<BinaryBoolFunction>()},
-    {"+", std::make_shared<BinaryIntegerFunction>()},
-    {"-", std::make_shared<BinaryIntegerFunction>()},
-    {"*", std::make_shared<BinaryIntegerFunction>()},
-    {"/", std::make_shared<BinaryIntegerFunction>()},
-    {"max", std::make_shared<BinaryIntegerFunction>()},
-    {"min", std::make_shared<BinaryIntegerFunction>()},
-    {"abs", std::make_shared<UnaryIntegerFunction>()}};
-
-std::shared_ptr<Object> DefinitePointer(const std::shared_ptr<Object>& object) {
-    if (Is<Symbol>(object) &&
-        (As<Symbol>(object)->GetName() == "#t" || As<Symbol>(object)->GetName() == "#f")) {
-        return std::make_shared<Boolean>(As<Symbol>(object)->GetName() == "#t");
-    }
-    return object;
-}
-
-std::shared_ptr<Object> Calc(std::shared_ptr<Object> object) {
-    if (object && Is<Cell>(object) && As<Cell>(object)->GetFirst()) {
-        if (Is<Symbol>(As<Cell>(object)->GetFirst()) &&
-            As<Symbol>(As<Cell>(object)->GetFirst())->GetName() == "quote") {
-            return As<Cell>(object)->GetSecond();
-        }
-    }
-    if (!object || Is<Number>(object) || Is<Symbol>(object) || Is<Dot>(object)) {
-        return object;
-    }
-    if (Is<Cell>(object)) {
-        As<Cell>(object)->SetFirst(Calc(As<Cell>(object)->GetFirst()));
-        As<Cell>(object)->SetSecond(Calc(As<Cell>(object)->GetSecond()));
-    }
-    if (Is<Symbol>(As<Cell>(object)->GetFirst()) &&
-        apply_function.find(As<Symbol>(As<Cell>(object)->GetFirst())->GetName()) !=
-            apply_function.end()) {
-        std::vector<std::shared_ptr<Object>> argument_collector;
-        std::shared_ptr<Object> argument_jumper = As<Cell>(object)->GetSecond();
-        while (argument_jumper) {
-            if (Is<Cell>(argument_jumper)) {
-                argument_collector.emplace_back(
-                    DefinitePointer(As<Cell>(argument_jumper)->GetFirst()));
-                argument_jumper = As<Cell>(argument_jumper)->GetSecond();
-                continue;
-            }
-            argument_collector.emplace_back(DefinitePointer(argument_jumper));
-            break;
+// frames Calc reserves up front, enough for the nesting of typical expressions
+const size_t kCalcStackReserve = 32;
+
+// A cell whose first and second are being calculated, and the value of its first once it is.
+struct CalcFrame {
+    std::shared_ptr<Object> cell;
+    std::shared_ptr<Object> first;
+    bool is_first_done = false;
+};
+
+// The lists read from source_map among the cells being calculated, outermost first.
+std::vector<ProfileFrame> GetProfileFrames(const std::vector<CalcFrame>& frames,
+                                           const SourceMap* source_map) {
+    std::vector<ProfileFrame> profile_frames;
+    if (!source_map) {
+        return profile_frames;
+    }
+    for (const CalcFrame& frame : frames) {
+        if (const SourceSpan* span = source_map->Find(frame.cell.get())) {
+            profile_frames.push_back({source_map, *span});
         }
-        return apply_function[As<Symbol>(As<Cell>(object)->GetFirst())->GetName()]->Apply(
-            As<Symbol>(As<Cell>(object)->GetFirst())->GetName(), argument_collector);
     }
-    return object;
+    return profile_frames;
 }
 
-std::string Interpreter::Run(const std::string& expression) {
+// Calculates every cell after its first and second, walking the tree with an explicit stack so
+// long lists and deep nesting don't exhaust the native one. The tree is only read: a cell whose
+// parts calculate to themselves is its own value, any other becomes a new cell.
+std::shared_ptr<Object> Calc(const std::shared_ptr<Object>& root) {
+    std::vector<CalcFrame> frames;
+    frames.reserve(kCalcStackReserve);
+    std::vector<std::shared_ptr<Object>> argument_collector;
+    std::shared_ptr<Object> object = root;
+    std::shared_ptr<Object> result;
+    ProfileScope* profile = ProfileScope::Current();
+    DeadlineScope* deadline = DeadlineScope::Current();
+    while (true) {
+        if (profile && profile->IsSampleDue()) {
+            profile->Sample(GetProfileFrames(frames, profile->GetSourceMap()));
+        }
+        if (deadline) {
+            deadline->Check();
+        }
+        if (IsQuoteForm(object)) {
+            result = QuotedDatum(object);
+        } else if (Is<Cell>(object)) {
+            frames.push_back({object, nullptr});
+            object = View<Cell>(object)->GetFirst();
+            continue;
+        } else {
+            result = std::move(object);
+        }
 
-    std::stringstream flow(expression);
-    Tokenizer tokenizer(&flow);
+        // `result` is calculated, hand it to the cell waiting for it
+        while (true) {
+            if (frames.empty()) {
+                return result;
+            }
+            CalcFrame& frame = frames.back();
+            Cell* cell = View<Cell>(frame.cell);
+            if (!frame.is_first_done) {
+                frame.first = std::move(result);
+                frame.is_first_done = true;
+                object = cell->GetSecond();
+                break;
+            }
+            if (IsBuiltinCall(frame.first)) {
+                argument_collector.clear();
+                CollectArguments(result, &argument_collector);
+                result = ApplyBuiltinFunction(View<Symbol>(frame.first)->GetId(),
+                                              argument_collector);
+                // the call is still on the stack, so a long one is charged to itself
+                if (profile && profile->IsSampleDue()) {
+                    profile->Sample(GetProfileFrames(frames, profile->GetSourceMap()));
+                }
+            } else if (frame.first.get() == cell->ViewFirst() &&
+                       result.get() == cell->ViewSecond()) {
+                result = std::move(frame.cell);
+            } else {
+                result = New<Cell>(std::move(frame.first), std::move(result));
+            }
+            frames.pop_back();
+        }
+    }
+}
 
-    std::shared_ptr<Object> ast = Read(&tokenizer);
-    if (!tokenizer.IsEnd()) {
-        throw SyntaxError("an expression can't be read in full size\n");
+// Whether (head ...) at the top level is something to evaluate rather than plain data.
+bool IsOperation(const std::shared_ptr<Object>& head, EvaluationMode mode) {
+    if (IsBuiltinCall(head)) {
+        return true;
+    }
+    if (mode == EvaluationMode::AST_WALKER) {
+        return false;
     }
+    if (Symbol* symbol = View<Symbol>(head)) {
+        return IsSpecialForm(symbol->GetId()) || IsVariableName(symbol->GetId());
+    }
+    // ((lambda ...) ...) or ((make-function ...) ...)
+    Cell* cell = View<Cell>(head);
+    return cell && Is<Symbol>(cell->GetFirst()) && !IsBuiltinCall(cell->GetFirst());
+}
+
+Interpreter::Interpreter(AllocationMode mode, EvaluationMode evaluation_mode)
+    : mode_{mode}, evaluation_mode_{evaluation_mode} {
+    if (mode_ == AllocationMode::SESSION_ARENA) {
+        session_arena_ = std::make_unique<Arena>();
+    }
+}
+
+// What a top-level form has to be to be evaluated, however it was read.
+void CheckExpression(const std::shared_ptr<Object>& ast, EvaluationMode mode) {
     if (!ast) {
         throw RuntimeError("empty expression\n");
     }
-    std::shared_ptr<Object> check_operations = ast;
-    if (Is<Cell>(check_operations)) {
-        if (!Is<Symbol>(As<Cell>(check_operations)->GetFirst()) ||
-            apply_function.find(As<Symbol>(As<Cell>(check_operations)->GetFirst())->GetName()) ==
-                apply_function.end()) {
+    if (Is<Cell>(ast)) {
+        if (!IsOperation(View<Cell>(ast)->GetFirst(), mode)) {
             throw RuntimeError("this expression has not operations\n");
         }
     }
-    ast = Calc(ast);
-    if (!ast) {
-        return std::make_shared<Nullptr>()->ToString();
+}
+
+std::shared_ptr<Object> ReadExpression(std::string_view expression, EvaluationMode mode,
+                                       SourceMap* spans = nullptr) {
+    Tokenizer tokenizer{expression};
+
+    std::shared_ptr<Object> ast = Read(&tokenizer, spans);
+    if (!tokenizer.IsEnd()) {
+        throw SyntaxError("an expression can't be read in full size\n");
+    }
+    CheckExpression(ast, mode);
+    return ast;
+}
+
+std::string Interpreter::Run(const std::string& expression) {
+    return RunForm(expression);
+}
+
+std::string Interpreter::RunForm(std::string_view expression) {
+    StatsScope stats_scope(GetStatsTotals());
+    if (result_cache_.IsEnabled()) {
+        if (const std::string* output = result_cache_.FindSource(std::string(expression))) {
+            fold_report_.folds.clear();
+            return *output;
+        }
+    }
+    std::string output = Evaluate(expression);
+    if (GetHeapBytes() >= next_collection_bytes_) {
+        CollectGarbage();
+    }
+    return output;
+}
+
+std::string Interpreter::Evaluate(std::string_view expression) {
+    // declared before any node, so every node of this run is destroyed before the arena is
+    std::unique_ptr<Arena> run_arena;
+    Arena* arena = session_arena_.get();
+    if (mode_ == AllocationMode::RUN_ARENA) {
+        run_arena = std::make_unique<Arena>();
+        arena = run_arena.get();
+    }
+    ArenaScope arena_scope(arena);
+    DeadlineScope deadline_scope(GetDeadline());
+    std::shared_ptr<SourceMap> source_map =
+        GetActiveProfiler() ? std::make_shared<SourceMap>(std::string(expression)) : nullptr;
+
+    fold_report_.folds.clear();
+    std::shared_ptr<Object> ast = TimePhase(Phase::READ, [&] {
+        return ReadExpression(expression, evaluation_mode_, source_map.get());
+    });
+    std::string cache_key;
+    // the text is only copied for the cache
+    std::string source;
+    if (result_cache_.IsEnabled() && IsCacheable(ast)) {
+        // the canonical form, evaluation may rewrite the tree
+        cache_key = Print(ast);
+        source = expression;
+        if (const std::string* output = result_cache_.Find(cache_key, source)) {
+            return *output;
+        }
+    }
+    bool defines_globals = false;
+    // kept however the run ends, a global may point into it
+    auto retain_run_arena = [&] {
+        if (defines_globals && run_arena) {
+            retained_arenas_.push_back(std::move(run_arena));
+        }
+    };
+    std::string output;
+    try {
+        output = EvaluateTree(std::move(ast), source_map, &defines_globals);
+    } catch (...) {
+        retain_run_arena();
+        throw;
+    }
+    retain_run_arena();
+    if (!cache_key.empty()) {
+        result_cache_.Insert(cache_key, source, output);
+    }
+    return output;
+}
+
+std::string Interpreter::EvaluateTree(std::shared_ptr<Object> ast,
+                                      std::shared_ptr<const SourceMap> source_map,
+                                      bool* defines_globals) {
+    Profiler* profiler = GetActiveProfiler();
+    ast = TimePhase(Phase::FOLD, [&] { return Fold(ast, &fold_report_); });
+    if (evaluation_mode_ == EvaluationMode::BYTECODE) {
+        Program program = TimePhase(Phase::COMPILE, [&] { return Compile(ast, source_map); });
+        // set before running, a define may be done by the time something throws
+        if (program.defines_globals) {
+            *defines_globals = true;
+        }
+        ProfileScope profile_scope(profiler, source_map.get());
+        ast = TimePhase(Phase::EVALUATE, [&] { return ::Execute(program, &globals_); });
+    } else {
+        ProfileScope profile_scope(profiler, source_map.get());
+        ast = TimePhase(Phase::EVALUATE, [&] { return Calc(ast); });
+    }
+    return TimePhase(Phase::PRINT, [&] { return Print(ast); });
+}
+
+std::shared_ptr<const PreparedExpression> Interpreter::Prepare(const std::string& expression) {
+    // the handle outlives the runs and may be passed to other threads, so it stays off arenas
+    ArenaScope heap_scope(nullptr);
+    StatsScope stats_scope(GetStatsTotals());
+    fold_report_.folds.clear();
+    auto prepared = std::make_shared<PreparedExpression>();
+    prepared->mode_ = evaluation_mode_;
+    std::shared_ptr<SourceMap> source_map =
+        GetActiveProfiler() ? std::make_shared<SourceMap>(expression) : nullptr;
+    prepared->source_map_ = source_map;
+    std::shared_ptr<Object> ast = TimePhase(Phase::READ, [&] {
+        return ReadExpression(expression, evaluation_mode_, source_map.get());
+    });
+    ast = TimePhase(Phase::FOLD, [&] { return Fold(ast, &fold_report_); });
+    if (evaluation_mode_ == EvaluationMode::BYTECODE) {
+        prepared->program_ = TimePhase(Phase::COMPILE, [&] {
+            return std::make_shared<const Program>(Compile(ast, source_map));
+        });
+    } else {
+        prepared->ast_ = std::move(ast);
+    }
+    return prepared;
+}
+
+std::string Interpreter::Execute(const PreparedExpression& prepared) {
+    if (prepared.mode_ != evaluation_mode_) {
+        throw RuntimeError("the expression was prepared for another evaluation mode\n");
+    }
+    ArenaScope heap_scope(nullptr);
+    StatsScope stats_scope(GetStatsTotals());
+    DeadlineScope deadline_scope(GetDeadline());
+    std::shared_ptr<Object> result = TimePhase(Phase::EVALUATE, [&] {
+        ProfileScope profile_scope(GetActiveProfiler(), prepared.source_map_.get());
+        if (evaluation_mode_ == EvaluationMode::BYTECODE) {
+            return ::Execute(*prepared.program_, &globals_);
+        }
+        return Calc(prepared.ast_);
+    });
+    return TimePhase(Phase::PRINT, [&] { return Print(result); });
+}
+
+size_t Interpreter::GetHeapBytes() const {
+    size_t bytes = session_arena_ ? session_arena_->GetBytesAllocated() : 0;
+    for (const std::unique_ptr<Arena>& arena : retained_arenas_) {
+        bytes += arena->GetBytesAllocated();
+    }
+    return bytes;
+}
+
+void Interpreter::CollectGarbage() {
+    if (mode_ == AllocationMode::HEAP) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    size_t heap_bytes = GetHeapBytes();
+
+    auto to_space = std::make_unique<Arena>();
+    {
+        ArenaScope arena_scope(to_space.get());
+        Relocator relocator;
+        // the originals stay reachable until everything is copied
+        std::vector<std::shared_ptr<Object>> copies;
+        globals_.ForEachValue(
+            [&](std::shared_ptr<Object>& value) { copies.push_back(relocator.Copy(value)); });
+        relocator.Finish();
+        auto copy = copies.begin();
+        globals_.ForEachValue([&](std::shared_ptr<Object>& value) { value = std::move(*copy++); });
+        gc_stats_.last_copied_objects = relocator.GetCopiedObjects();
+    }
+    // the old nodes have been released while their arenas were still there
+    retained_arenas_.clear();
+    if (mode_ == AllocationMode::SESSION_ARENA) {
+        session_arena_ = std::move(to_space);
+    } else {
+        retained_arenas_.push_back(std::move(to_space));
+    }
+
+    size_t live_bytes = GetHeapBytes();
+    next_collection_bytes_ = std::max(kGcInitialThreshold, 2 * live_bytes);
+    std::chrono::nanoseconds pause = std::chrono::steady_clock::now() - start;
+    ++gc_stats_.collections;
+    gc_stats_.last_live_bytes = live_bytes;
+    gc_stats_.last_reclaimed_bytes = heap_bytes > live_bytes ? heap_bytes - live_bytes : 0;
+    gc_stats_.last_pause = pause;
+    gc_stats_.max_pause = std::max(gc_stats_.max_pause, pause);
+    gc_stats_.total_pause += pause;
+}
+
+GcStats Interpreter::GetGcStats() const {
+    GcStats stats = gc_stats_;
+    stats.heap_bytes = GetHeapBytes();
+    return stats;
+}
+
+const FoldReport& Interpreter::GetFoldReport() const {
+    return fold_report_;
+}
+
+void Interpreter::SetResultCacheLimits(ResultCacheLimits limits) {
+    result_cache_.SetLimits(limits);
+}
+
+ResultCacheStats Interpreter::GetResultCacheStats() const {
+    return result_cache_.GetStats();
+}
+
+void Interpreter::SetRuntimeStatsEnabled(bool enabled) {
+    is_stats_enabled_ = enabled;
+}
+
+RuntimeStats Interpreter::GetRuntimeStats() const {
+    return stats_->Get();
+}
+
+SharedStats* Interpreter::GetStatsTotals() {
+    return is_stats_enabled_ ? stats_.get() : nullptr;
+}
+
+void Interpreter::StartProfiling(std::chrono::microseconds interval) {
+    profiler_ = std::make_unique<Profiler>(interval);
+    is_profiling_ = true;
+}
+
+void Interpreter::StopProfiling() {
+    if (profiler_) {
+        profiler_->Stop();
+    }
+    is_profiling_ = false;
+}
+
+std::string Interpreter::GetProfile() const {
+    return profiler_ ? profiler_->GetFoldedStacks() : std::string();
+}
+
+void Interpreter::SetTimeLimit(std::chrono::nanoseconds limit) {
+    time_limit_ = limit;
+}
+
+std::optional<std::chrono::steady_clock::time_point> Interpreter::GetDeadline() const {
+    if (time_limit_ == std::chrono::nanoseconds::zero()) {
+        return std::nullopt;
+    }
+    return std::chrono::steady_clock::now() + time_limit_;
+}
+
+Profiler* Interpreter::GetActiveProfiler() {
+    return is_profiling_ ? profiler_.get() : nullptr;
+}
+
+template <class Forms>
+std::vector<BatchResult> Interpreter::RunForms(const Forms& forms) {
+    std::vector<BatchResult> results(forms.size());
+    for (size_t i = 0; i < forms.size(); ++i) {
+        try {
+            results[i].output = RunForm(forms[i]);
+        } catch (...) {
+            results[i].error = std::current_exception();
+        }
+    }
+    return results;
+}
+
+std::vector<BatchResult> Interpreter::Feed(std::string_view chunk) {
+    std::vector<std::string> forms;
+    form_reader_.Feed(chunk, &forms);
+    return RunForms(forms);
+}
+
+std::vector<BatchResult> Interpreter::FinishFeed() {
+    std::vector<std::string> forms;
+    form_reader_.Finish(&forms);
+    return RunForms(forms);
+}
+
+namespace {
+
+// A file mapped read-only for the lifetime of the object.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "can't open " + path);
+        }
+        struct stat status;
+        if (fstat(fd, &status) < 0) {
+            int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), "can't stat " + path);
+        }
+        size_ = static_cast<size_t>(status.st_size);
+        if (size_) {
+            // the mapping stays valid once the descriptor is closed
+            data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        int error = errno;
+        close(fd);
+        if (data_ == MAP_FAILED) {
+            throw std::system_error(error, std::generic_category(), "can't map " + path);
+        }
+        if (size_) {
+            // forms are read front to back, once
+            madvise(data_, size_, MADV_SEQUENTIAL);
+        }
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() {
+        if (size_) {
+            munmap(data_, size_);
+        }
+    }
+
+    std::string_view GetText() const {
+        return {static_cast<const char*>(data_), size_};
+    }
+
+private:
+    // an empty file has nothing to map
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+}  // namespace
+
+FileRunResult Interpreter::RunFile(const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+    MappedFile file(path);
+    std::string_view text = file.GetText();
+    FileRunResult result;
+    result.bytes = text.size();
+    result.forms = RunForms(FormReader::Split(text));
+    result.time = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+FileRunResult Interpreter::RunAstImage(const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+    MappedFile file(path);
+    AstImage image(file.GetText());
+    FileRunResult result;
+    result.bytes = file.GetText().size();
+
+    // one arena for the whole image, kept like the arena of a run if a form defines globals
+    std::unique_ptr<Arena> image_arena;
+    Arena* arena = session_arena_.get();
+    if (mode_ == AllocationMode::RUN_ARENA) {
+        image_arena = std::make_unique<Arena>();
+        arena = image_arena.get();
+    }
+    bool defines_globals = false;
+    {
+        ArenaScope arena_scope(arena);
+        std::vector<std::shared_ptr<Object>> forms = image.Load();
+        result.forms.resize(forms.size());
+        for (size_t i = 0; i < forms.size(); ++i) {
+            try {
+                StatsScope stats_scope(GetStatsTotals());
+                DeadlineScope deadline_scope(GetDeadline());
+                fold_report_.folds.clear();
+                CheckExpression(forms[i], evaluation_mode_);
+                // shared by the forms, so a define is known even if its form then throws
+                result.forms[i].output =
+                    EvaluateTree(std::move(forms[i]), nullptr, &defines_globals);
+            } catch (...) {
+                result.forms[i].error = std::current_exception();
+            }
+        }
+    }
+    if (defines_globals && image_arena) {
+        retained_arenas_.push_back(std::move(image_arena));
+    }
+    // not between the forms, a collection would replace the session arena they are loaded in
+    if (GetHeapBytes() >= next_collection_bytes_) {
+        CollectGarbage();
+    }
+    result.time = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+std::string Interpreter::RunIsolated(const std::string& expression) {
+    // the session arena belongs to the thread calling Run, so a worker always uses its own
+    std::unique_ptr<Arena> run_arena;
+    if (mode_ != AllocationMode::HEAP) {
+        run_arena = std::make_unique<Arena>();
+    }
+    ArenaScope arena_scope(run_arena.get());
+    StatsScope stats_scope(GetStatsTotals());
+    DeadlineScope deadline_scope(GetDeadline());
+    Profiler* profiler = GetActiveProfiler();
+    std::shared_ptr<SourceMap> source_map =
+        profiler ? std::make_shared<SourceMap>(expression) : nullptr;
+
+    std::shared_ptr<Object> ast = TimePhase(Phase::READ, [&] {
+        return ReadExpression(expression, evaluation_mode_, source_map.get());
+    });
+    ast = TimePhase(Phase::FOLD, [&] { return Fold(ast, nullptr); });
+    if (evaluation_mode_ == EvaluationMode::BYTECODE) {
+        Program program = TimePhase(Phase::COMPILE, [&] { return Compile(ast, source_map); });
+        if (program.defines_globals) {
+            throw RuntimeError("define can't be used in a batch\n");
+        }
+        ProfileScope profile_scope(profiler, source_map.get());
+        ast = TimePhase(Phase::EVALUATE, [&] { return ::Execute(program, &globals_); });
+    } else {
+        ProfileScope profile_scope(profiler, source_map.get());
+        ast = TimePhase(Phase::EVALUATE, [&] { return Calc(ast); });
     }
-    return ast->ToString();
-}
\ No newline at end of file
+    return TimePhase(Phase::PRINT, [&] { return Print(ast); });
+}
+
+std::vector<BatchResult> Interpreter::RunBatch(const std::vector<std::string>& expressions,
+                                               size_t thread_count) {
+    std::vector<BatchResult> results(expressions.size());
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    thread_count = std::min(thread_count, expressions.size());
+
+    std::atomic<size_t> next_expression = 0;
+    auto work = [&] {
+        for (size_t i = next_expression++; i < expressions.size(); i = next_expression++) {
+            try {
+                results[i].output = RunIsolated(expressions[i]);
+            } catch (...) {
+                results[i].error = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < thread_count; ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return results;
+}
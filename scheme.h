@@ -1,13 +1,174 @@
 #pragma once
 
+#include <chrono>
+#include <exception>
 #include <map>
+#include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include "arena.h"
+#include "ast_image.h"
+#include "bytecode.h"
+#include "deadline.h"
+#include "fold.h"
+#include "gc.h"
 #include "parser.h"
+#include "printer.h"
+#include "profiler.h"
+#include "result_cache.h"
+#include "runtime_stats.h"
 #include "tokenizer.h"
 
+// Where the nodes built by Run are allocated.
+enum class AllocationMode {
+    HEAP,           // one std::make_shared per node
+    RUN_ARENA,      // a fresh arena per Run call, released in bulk when Run returns
+    SESSION_ARENA,  // one arena for the lifetime of the interpreter
+};
+
+// How Run evaluates the parsed expression.
+enum class EvaluationMode {
+    AST_WALKER,  // Calc, walks the tree without changing it; no define, lambda, let or if
+    BYTECODE,    // Compile to a Program and Execute it on a stack machine
+};
+
+// Outcome of one expression of a batch: what Run would have returned, or what it would have thrown.
+struct BatchResult {
+    std::string output;
+    std::exception_ptr error;
+};
+
+// What Interpreter::RunFile did: the outcome of every top-level form of the file in order, the
+// size of the file and the wall time of the whole load.
+struct FileRunResult {
+    std::vector<BatchResult> forms;
+    size_t bytes = 0;
+    std::chrono::nanoseconds time{0};
+};
+
+// An expression read, folded and compiled once by Interpreter::Prepare. Nothing changes it
+// afterwards and none of it lives in an arena, so it can be executed any number of times, from
+// any thread, for as long as the handle is kept.
+class PreparedExpression {
+private:
+    friend class Interpreter;
+
+    EvaluationMode mode_ = EvaluationMode::BYTECODE;
+    std::shared_ptr<Object> ast_;                  // what Calc walks
+    std::shared_ptr<const Program> program_;       // what the stack machine runs
+    std::shared_ptr<const SourceMap> source_map_;  // only if prepared while profiling
+};
+
+// Session data is collected once its arenas grow past this, then past twice what survived.
+const size_t kGcInitialThreshold = 1 << 20;
+
+// An interpreter is a session: globals made by define stay visible to later Run calls.
 class Interpreter {
 public:
+    explicit Interpreter(AllocationMode mode = AllocationMode::RUN_ARENA,
+                         EvaluationMode evaluation_mode = EvaluationMode::BYTECODE);
     std::string Run(const std::string&);
+    // Run in two steps, so an expression which is evaluated again and again is only read once.
+    // Handles which don't define globals can be executed by several threads at once.
+    std::shared_ptr<const PreparedExpression> Prepare(const std::string& expression);
+    std::string Execute(const PreparedExpression& prepared);
+    // Evaluates independent expressions on `thread_count` workers (one per core by default). They
+    // see the globals defined so far but can't define new ones. Results keep the input order.
+    std::vector<BatchResult> RunBatch(const std::vector<std::string>& expressions,
+                                      size_t thread_count = 0);
+    // Run for a stream of top-level forms given in chunks, which may split a form anywhere. Each
+    // form is run as soon as the chunk which completes it comes in; the results of the forms
+    // completed by one chunk are returned in order. FinishFeed ends the stream, running what is
+    // left of it.
+    std::vector<BatchResult> Feed(std::string_view chunk);
+    std::vector<BatchResult> FinishFeed();
+    // Run for every top-level form of a file, in order. The file is mapped into memory and the
+    // forms are read where they lie in the mapping, without copying the text. A form which fails
+    // doesn't stop the ones after it. Throws std::system_error if the file can't be mapped.
+    FileRunResult RunFile(const std::string& path);
+    // RunFile for an image made by WriteAstImage: the forms are built straight from the mapped
+    // image, without the tokenizer or the reader, in the arena a run would use, and then run in
+    // order. Throws std::system_error if the file can't be mapped and SyntaxError if it isn't an
+    // image of this version or is damaged.
+    FileRunResult RunAstImage(const std::string& path);
+
+    // Copies what the globals reach into a fresh arena and frees the arenas of earlier runs.
+    // Run calls it when they have grown enough; with AllocationMode::HEAP there is nothing to do,
+    // reference counting already frees every node that isn't reachable.
+    void CollectGarbage();
+    GcStats GetGcStats() const;
+    // The constant calls the last Run replaced by their values before evaluating.
+    const FoldReport& GetFoldReport() const;
+
+    // Remembers the outputs of expressions which only call builtins, so Run answers a repeat of
+    // one without reading or evaluating it. Nothing is cached until the limits are nonzero.
+    void SetResultCacheLimits(ResultCacheLimits limits);
+    ResultCacheStats GetResultCacheStats() const;
+
+    // Counts what the runs that follow do: wall time per phase, calls and time per builtin,
+    // objects allocated per type. Scheme code can read the counts with (runtime-stats) while
+    // enabled. Off by default, then the instrumentation costs one thread-local check per
+    // allocation and per builtin call. Disabling keeps the counts so far.
+    void SetRuntimeStatsEnabled(bool enabled);
+    RuntimeStats GetRuntimeStats() const;
+
+    // Run, Execute and RunBatch calls which follow throw TimeoutError once evaluating one
+    // expression has taken longer than limit; zero, the default, means no limit. The clock is
+    // read at the safe points of the evaluators, see DeadlineScope; reading, folding and
+    // compiling are not interrupted.
+    void SetTimeLimit(std::chrono::nanoseconds limit);
+
+    // Samples which expressions evaluation spends its time in, every interval, until
+    // StopProfiling. Runs read while profiling keep the spans of their lists, so samples name
+    // expressions by their text and position; samples of code read before are not attributed.
+    // Starting again discards the samples of the last profiling.
+    void StartProfiling(std::chrono::microseconds interval = kDefaultProfileInterval);
+    void StopProfiling();
+    // The samples of the last profiling as folded stacks, see Profiler::GetFoldedStacks.
+    std::string GetProfile() const;
+
+private:
+    // Run for text which needn't be a std::string.
+    std::string RunForm(std::string_view expression);
+    std::string Evaluate(std::string_view expression);
+    // Evaluate from the fold on, for a tree read already. Sets *defines_globals, before running
+    // anything, if the tree was compiled to a program which defines globals; never clears it.
+    std::string EvaluateTree(std::shared_ptr<Object> ast,
+                             std::shared_ptr<const SourceMap> source_map, bool* defines_globals);
+    size_t GetHeapBytes() const;
+
+    // RunForm for each form, with the exceptions caught.
+    template <class Forms>
+    std::vector<BatchResult> RunForms(const Forms& forms);
+
+    // Run for a batch worker: private arena, read-only globals.
+    std::string RunIsolated(const std::string& expression);
+    // Where a run adds its counts, nullptr if runtime statistics are disabled.
+    SharedStats* GetStatsTotals();
+    // nullptr unless profiling
+    Profiler* GetActiveProfiler();
+    // when a run starting now has to stop, nothing without a time limit
+    std::optional<std::chrono::steady_clock::time_point> GetDeadline() const;
+
+    AllocationMode mode_;
+    EvaluationMode evaluation_mode_;
+    std::unique_ptr<Arena> session_arena_;
+    // arenas of runs which defined globals, they hold nodes reachable from globals_
+    std::vector<std::unique_ptr<Arena>> retained_arenas_;
+    GlobalEnvironment globals_;
+    GcStats gc_stats_;
+    FoldReport fold_report_;
+    ResultCache result_cache_;
+    FormReader form_reader_;
+    size_t next_collection_bytes_ = kGcInitialThreshold;
+    bool is_stats_enabled_ = false;
+    // batch workers add their counts concurrently
+    std::unique_ptr<SharedStats> stats_ = std::make_unique<SharedStats>();
+    bool is_profiling_ = false;
+    std::unique_ptr<Profiler> profiler_;
+    std::chrono::nanoseconds time_limit_{0};
 };
@@ -0,0 +1,555 @@
+#include "server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <latch>
+#include <system_error>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "error.h"
+#include "scheme.h"
+
+namespace {
+
+// run by every worker before the server answers anything
+const char* const kWarmUpExpression = "(car (list (+ 1 2) (* 3 4)))";
+const size_t kReadBufferSize = 1 << 16;
+const int kMaxEvents = 64;
+// how long the server stops accepting connections when it runs out of descriptors
+const std::chrono::milliseconds kAcceptPause{100};
+
+std::system_error MakeSystemError(const std::string& what) {
+    return std::system_error(errno, std::generic_category(), what);
+}
+
+sockaddr_un MakeAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::system_error(ENAMETOOLONG, std::generic_category(), path);
+    }
+    path.copy(address.sun_path, path.size());
+    return address;
+}
+
+std::string EncodeFrame(uint8_t type, std::string_view payload) {
+    std::string frame(kFrameHeaderSize, '\0');
+    frame[0] = static_cast<char>(type);
+    uint32_t size = static_cast<uint32_t>(payload.size());
+    for (size_t i = 0; i < 4; ++i) {
+        frame[i + 1] = static_cast<char>(size >> (8 * i));
+    }
+    frame += payload;
+    return frame;
+}
+
+uint32_t DecodeSize(const char* header) {
+    uint32_t size = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        size |= static_cast<uint32_t>(static_cast<unsigned char>(header[i + 1])) << (8 * i);
+    }
+    return size;
+}
+
+bool WriteAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        ssize_t size = send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (size < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data.remove_prefix(size);
+    }
+    return true;
+}
+
+bool ReadAll(int fd, char* data, size_t size) {
+    while (size) {
+        ssize_t read_size = recv(fd, data, size, 0);
+        if (read_size == 0) {
+            errno = ECONNRESET;
+            return false;
+        }
+        if (read_size < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += read_size;
+        size -= read_size;
+    }
+    return true;
+}
+
+void Watch(int epoll_fd, int fd) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        throw MakeSystemError("can't watch a descriptor");
+    }
+}
+
+int64_t Percentile(std::vector<int64_t>* values, size_t percent) {
+    auto nth = values->begin() + (values->size() - 1) * percent / 100;
+    std::nth_element(values->begin(), nth, values->end());
+    return *nth;
+}
+
+}  // namespace
+
+struct Server::Request {
+    uint8_t kind = 0;
+    std::string payload;
+    std::chrono::steady_clock::time_point read_at;
+    // answered OVERLOADED without being run
+    bool is_rejected = false;
+
+    bool IsEvaluated() const {
+        return kind == static_cast<uint8_t>(RequestKind::EVALUATE) && !is_rejected;
+    }
+};
+
+struct Server::Connection {
+    explicit Connection(int fd) : fd{fd} {
+    }
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+    ~Connection() {
+        close(fd);
+    }
+
+    const int fd;
+    // the start of a frame not read in full, only used by Serve
+    std::string input;
+
+    std::mutex mutex;
+    // read and not answered yet, in order
+    std::deque<Request> pending;
+    // a worker is answering pending, so nothing else may be written meanwhile
+    bool is_busy = false;
+    // responses the socket hasn't taken yet, sent as it drains
+    std::string output;
+    // what epoll is watching the socket for
+    uint32_t events = EPOLLIN;
+};
+
+std::string FormatServerMetrics(const ServerMetrics& metrics) {
+    std::string output;
+    auto add = [&](const char* name, int64_t value) {
+        output += name;
+        output += ' ';
+        output += std::to_string(value);
+        output += '\n';
+    };
+    add("requests", metrics.requests);
+    add("errors", metrics.errors);
+    add("timeouts", metrics.timeouts);
+    add("rejected", metrics.rejected);
+    add("p50_latency_ns", metrics.p50_latency.count());
+    add("p99_latency_ns", metrics.p99_latency.count());
+    add("queue_depth", metrics.queue_depth);
+    add("max_queue_depth", metrics.max_queue_depth);
+    return output;
+}
+
+Server::Server(ServerOptions options) : options_{std::move(options)} {
+    if (options_.worker_count == 0) {
+        options_.worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    try {
+        sockaddr_un address = MakeAddress(options_.socket_path);
+        stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (stop_fd_ < 0) {
+            throw MakeSystemError("can't make an eventfd");
+        }
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd_ < 0) {
+            throw MakeSystemError("can't make an epoll instance");
+        }
+        listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0) {
+            throw MakeSystemError("can't make a socket");
+        }
+        unlink(options_.socket_path.c_str());
+        if (bind(listen_fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+            throw MakeSystemError("can't bind " + options_.socket_path);
+        }
+        if (listen(listen_fd_, SOMAXCONN) < 0) {
+            throw MakeSystemError("can't listen on " + options_.socket_path);
+        }
+        Watch(epoll_fd_, stop_fd_);
+        Watch(epoll_fd_, listen_fd_);
+    } catch (...) {
+        Close();
+        throw;
+    }
+
+    std::latch warm(options_.worker_count);
+    for (size_t i = 0; i < options_.worker_count; ++i) {
+        workers_.emplace_back([this, &warm] {
+            Interpreter().Run(kWarmUpExpression);
+            warm.count_down();
+            Work();
+        });
+    }
+    warm.wait();
+}
+
+Server::~Server() {
+    {
+        std::lock_guard lock(ready_mutex_);
+        is_stopping_ = true;
+    }
+    ready_changed_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+    connections_.clear();
+    Close();
+    unlink(options_.socket_path.c_str());
+}
+
+void Server::Close() {
+    for (int fd : {listen_fd_, epoll_fd_, stop_fd_}) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+void Server::Serve() {
+    epoll_event events[kMaxEvents];
+    while (true) {
+        int timeout = -1;
+        if (accept_resumes_at_) {
+            auto pause = std::chrono::ceil<std::chrono::milliseconds>(
+                *accept_resumes_at_ - std::chrono::steady_clock::now());
+            if (pause.count() > 0) {
+                timeout = pause.count();
+            } else {
+                accept_resumes_at_.reset();
+                Watch(epoll_fd_, listen_fd_);
+            }
+        }
+        int count = epoll_wait(epoll_fd_, events, kMaxEvents, timeout);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw MakeSystemError("can't wait for requests");
+        }
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == stop_fd_) {
+                return;
+            }
+            if (fd == listen_fd_) {
+                Accept();
+                continue;
+            }
+            auto it = connections_.find(fd);
+            if (it == connections_.end()) {
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                std::lock_guard lock(it->second->mutex);
+                Flush(it->second.get());
+            }
+            // a worker may still hold the connection, it closes with the last reference
+            if ((events[i].events & ~EPOLLOUT) && !Read(it->second)) {
+                epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+                connections_.erase(it);
+            }
+        }
+    }
+}
+
+void Server::Stop() {
+    uint64_t one = 1;
+    // only async-signal-safe calls here
+    [[maybe_unused]] ssize_t size = write(stop_fd_, &one, sizeof(one));
+}
+
+void Server::Accept() {
+    while (true) {
+        // nonblocking, a client which doesn't read its responses holds up nobody
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                // e.g. out of descriptors; the waiting client keeps the socket readable, so
+                // rather than spin on it, stop watching it for a while
+                std::cerr << "scheme server: can't accept a connection: " << std::strerror(errno)
+                          << "\n";
+                epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, listen_fd_, nullptr);
+                accept_resumes_at_ = std::chrono::steady_clock::now() + kAcceptPause;
+            }
+            return;
+        }
+        auto connection = std::make_shared<Connection>(fd);
+        try {
+            Watch(epoll_fd_, fd);
+        } catch (const std::system_error&) {
+            continue;
+        }
+        connections_.emplace(fd, std::move(connection));
+    }
+}
+
+bool Server::Read(const std::shared_ptr<Connection>& connection) {
+    char buffer[kReadBufferSize];
+    ssize_t read_size = recv(connection->fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+    if (read_size == 0) {
+        return false;
+    }
+    if (read_size < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    auto read_at = std::chrono::steady_clock::now();
+    std::string& input = connection->input;
+    input.append(buffer, read_size);
+    size_t begin = 0;
+    while (input.size() - begin >= kFrameHeaderSize) {
+        uint32_t size = DecodeSize(input.data() + begin);
+        if (size > kMaxRequestSize) {
+            return false;
+        }
+        if (input.size() - begin - kFrameHeaderSize < size) {
+            break;
+        }
+        Request request;
+        request.kind = static_cast<uint8_t>(input[begin]);
+        request.payload = input.substr(begin + kFrameHeaderSize, size);
+        request.read_at = read_at;
+        begin += kFrameHeaderSize + size;
+        if (!Dispatch(connection, std::move(request))) {
+            return false;
+        }
+    }
+    input.erase(0, begin);
+    return true;
+}
+
+bool Server::Dispatch(const std::shared_ptr<Connection>& connection, Request request) {
+    if (request.IsEvaluated() && queue_depth_.load() >= options_.queue_capacity) {
+        request.is_rejected = true;
+    }
+    std::unique_lock lock(connection->mutex);
+    if (!connection->is_busy && !request.IsEvaluated()) {
+        // nothing ahead of it on the connection and nothing to evaluate, answered right here;
+        // the response is only queued, so this doesn't wait for the client
+        lock.unlock();
+        Respond(connection.get(), request, Answer(request));
+        return true;
+    }
+    if (connection->pending.size() >= options_.connection_capacity) {
+        return false;
+    }
+    if (request.IsEvaluated()) {
+        // only this thread adds to the queue
+        size_t depth = ++queue_depth_;
+        if (depth > max_queue_depth_.load()) {
+            max_queue_depth_ = depth;
+        }
+    }
+    connection->pending.push_back(std::move(request));
+    if (connection->is_busy) {
+        return true;
+    }
+    connection->is_busy = true;
+    lock.unlock();
+    {
+        std::lock_guard ready_lock(ready_mutex_);
+        ready_.push_back(connection);
+    }
+    ready_changed_.notify_one();
+    return true;
+}
+
+void Server::Work() {
+    while (true) {
+        std::shared_ptr<Connection> connection;
+        {
+            std::unique_lock lock(ready_mutex_);
+            ready_changed_.wait(lock, [this] { return is_stopping_ || !ready_.empty(); });
+            if (is_stopping_) {
+                return;
+            }
+            connection = std::move(ready_.front());
+            ready_.pop_front();
+        }
+        // the requests of a connection are answered in order, by one worker at a time
+        while (true) {
+            Request request;
+            {
+                std::lock_guard lock(connection->mutex);
+                request = std::move(connection->pending.front());
+                connection->pending.pop_front();
+            }
+            if (request.IsEvaluated()) {
+                --queue_depth_;
+            }
+            Respond(connection.get(), request, Answer(request));
+            std::lock_guard lock(connection->mutex);
+            if (connection->pending.empty()) {
+                connection->is_busy = false;
+                break;
+            }
+        }
+    }
+}
+
+Server::Response Server::Answer(const Request& request) {
+    if (request.is_rejected) {
+        return {ResponseStatus::OVERLOADED, "too many requests are waiting\n"};
+    }
+    switch (static_cast<RequestKind>(request.kind)) {
+        case RequestKind::EVALUATE:
+            break;
+        case RequestKind::METRICS:
+            return {ResponseStatus::OK, FormatServerMetrics(GetMetrics())};
+        default:
+            return {ResponseStatus::BAD_REQUEST, "unknown request kind\n"};
+    }
+
+    std::chrono::nanoseconds time_limit{0};
+    if (options_.request_timeout != std::chrono::nanoseconds::zero()) {
+        time_limit = request.read_at + options_.request_timeout - std::chrono::steady_clock::now();
+        if (time_limit <= std::chrono::nanoseconds::zero()) {
+            return {ResponseStatus::TIMEOUT, "timed out waiting for a worker\n"};
+        }
+    }
+    Interpreter interpreter;
+    interpreter.SetTimeLimit(time_limit);
+    try {
+        return {ResponseStatus::OK, interpreter.Run(request.payload)};
+    } catch (const TimeoutError& error) {
+        return {ResponseStatus::TIMEOUT, error.what()};
+    } catch (const std::exception& error) {
+        return {ResponseStatus::ERROR, error.what()};
+    }
+}
+
+void Server::Respond(Connection* connection, const Request& request, const Response& response) {
+    {
+        std::lock_guard lock(connection->mutex);
+        connection->output += EncodeFrame(static_cast<uint8_t>(response.status), response.payload);
+        Flush(connection);
+    }
+    std::chrono::nanoseconds latency = std::chrono::steady_clock::now() - request.read_at;
+
+    std::lock_guard lock(metrics_mutex_);
+    ++totals_.requests;
+    if (response.status == ResponseStatus::ERROR) {
+        ++totals_.errors;
+    } else if (response.status == ResponseStatus::TIMEOUT) {
+        ++totals_.timeouts;
+    } else if (response.status == ResponseStatus::OVERLOADED) {
+        ++totals_.rejected;
+    }
+    if (latencies_.size() < kLatencyWindow) {
+        latencies_.push_back(latency.count());
+    } else {
+        latencies_[next_latency_] = latency.count();
+        next_latency_ = (next_latency_ + 1) % kLatencyWindow;
+    }
+}
+
+void Server::Flush(Connection* connection) {
+    std::string& output = connection->output;
+    size_t sent = 0;
+    while (sent < output.size()) {
+        ssize_t size = send(connection->fd, output.data() + sent, output.size() - sent,
+                            MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (size >= 0) {
+            sent += size;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else if (errno != EINTR) {
+            // the client is gone and loses its responses, Serve closes the connection on the
+            // hangup
+            sent = output.size();
+        }
+    }
+    output.erase(0, sent);
+
+    // a client which doesn't read its responses isn't read from either
+    uint32_t events = 0;
+    if (output.size() <= kMaxUnsentSize) {
+        events |= EPOLLIN;
+    }
+    if (!output.empty()) {
+        events |= EPOLLOUT;
+    }
+    if (events != connection->events) {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = connection->fd;
+        // fails only if Serve has closed the connection already, nothing to watch then
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection->fd, &event);
+        connection->events = events;
+    }
+}
+
+ServerMetrics Server::GetMetrics() const {
+    ServerMetrics metrics;
+    std::vector<int64_t> latencies;
+    {
+        std::lock_guard lock(metrics_mutex_);
+        metrics = totals_;
+        latencies = latencies_;
+    }
+    metrics.queue_depth = queue_depth_.load();
+    metrics.max_queue_depth = max_queue_depth_.load();
+    if (!latencies.empty()) {
+        metrics.p50_latency = std::chrono::nanoseconds(Percentile(&latencies, 50));
+        metrics.p99_latency = std::chrono::nanoseconds(Percentile(&latencies, 99));
+    }
+    return metrics;
+}
+
+ServerClient::ServerClient(const std::string& socket_path) {
+    sockaddr_un address = MakeAddress(socket_path);
+    fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        throw MakeSystemError("can't make a socket");
+    }
+    if (connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+        std::system_error error = MakeSystemError("can't connect to " + socket_path);
+        close(fd_);
+        throw error;
+    }
+}
+
+ServerClient::~ServerClient() {
+    close(fd_);
+}
+
+ServerResponse ServerClient::Send(RequestKind kind, std::string_view payload) {
+    if (!WriteAll(fd_, EncodeFrame(static_cast<uint8_t>(kind), payload))) {
+        throw MakeSystemError("can't send a request");
+    }
+    char header[kFrameHeaderSize];
+    if (!ReadAll(fd_, header, sizeof(header))) {
+        throw MakeSystemError("can't read a response");
+    }
+    ServerResponse response{static_cast<ResponseStatus>(header[0]),
+                            std::string(DecodeSize(header), '\0')};
+    if (!ReadAll(fd_, response.payload.data(), response.payload.size())) {
+        throw MakeSystemError("can't read a response");
+    }
+    return response;
+}
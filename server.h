@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// A request or a response on the socket is a frame: one byte, the kind of a request or the status
+// of a response, the length of the payload as four bytes, least significant first, then the
+// payload. Responses on a connection come in the order of its requests.
+const size_t kFrameHeaderSize = 5;
+// a longer request is not answered, its connection is closed
+const uint32_t kMaxRequestSize = 1 << 20;
+// while more than this of the responses on a connection is unsent, its requests are not read
+const size_t kMaxUnsentSize = 1 << 20;
+// the last requests, whose latencies make up the percentiles of ServerMetrics
+const size_t kLatencyWindow = 4096;
+
+enum class RequestKind : uint8_t {
+    EVALUATE,  // the payload is an expression, as for Interpreter::Run
+    METRICS,   // no payload, answered with FormatServerMetrics
+};
+
+enum class ResponseStatus : uint8_t {
+    OK,           // the payload is the output of the expression, or the metrics
+    ERROR,        // the payload is the message of what evaluating the expression threw
+    TIMEOUT,      // not answered within ServerOptions::request_timeout, the expression was dropped
+    OVERLOADED,   // too many requests were waiting, this one was not run
+    BAD_REQUEST,  // a kind the server doesn't know
+};
+
+struct ServerOptions {
+    std::string socket_path;
+    // one per core if zero
+    size_t worker_count = 0;
+    // from reading a request to the end of its evaluation, the wait for a worker included; zero
+    // for no limit
+    std::chrono::nanoseconds request_timeout = std::chrono::milliseconds(100);
+    // requests read beyond this many waiting for a worker are answered OVERLOADED at once
+    size_t queue_capacity = 1024;
+    // requests of any kind one connection may have read and not answered; a connection which
+    // sends more without waiting is closed
+    size_t connection_capacity = 1024;
+};
+
+struct ServerMetrics {
+    // answered, whatever the status
+    uint64_t requests = 0;
+    uint64_t errors = 0;
+    uint64_t timeouts = 0;
+    uint64_t rejected = 0;
+    // from reading a request to queuing its response, over the last kLatencyWindow requests
+    std::chrono::nanoseconds p50_latency{0};
+    std::chrono::nanoseconds p99_latency{0};
+    // requests read and waiting for a worker
+    size_t queue_depth = 0;
+    size_t max_queue_depth = 0;
+};
+
+// One "name value" line per metric, latencies in nanoseconds.
+std::string FormatServerMetrics(const ServerMetrics& metrics);
+
+// Evaluates expressions sent over a Unix domain socket on a fixed pool of worker threads, which
+// the constructor starts and warms up, so the first requests don't pay for it either. Every
+// request is run by a fresh Interpreter, as if by a process of its own, so nothing one request
+// defines is seen by another; what's saved is starting a process and initializing the global
+// tables for each.
+class Server {
+public:
+    // Starts the workers and listens on the socket, replacing a file left at its path. Throws
+    // std::system_error if the socket can't be made.
+    explicit Server(ServerOptions options);
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+    // Waits for the workers to finish the requests they have begun; Serve must have returned.
+    ~Server();
+
+    // Reads requests and hands them to the workers until Stop.
+    void Serve();
+    // Makes Serve return. Safe to call from any thread and from a signal handler.
+    void Stop();
+
+    ServerMetrics GetMetrics() const;
+
+private:
+    struct Request;
+    struct Connection;
+    struct Response {
+        ResponseStatus status;
+        std::string payload;
+    };
+
+    void Close();
+    void Accept();
+    // false once the connection is closed
+    bool Read(const std::shared_ptr<Connection>& connection);
+    // false if the connection has too many requests pending and is to be closed
+    bool Dispatch(const std::shared_ptr<Connection>& connection, Request request);
+    void Work();
+    Response Answer(const Request& request);
+    // Queues the response on the connection and sends what the socket takes of it.
+    void Respond(Connection* connection, const Request& request, const Response& response);
+    // Sends what the socket takes of the output of connection without waiting, and has Serve
+    // watch for it to drain if something is left. The mutex of connection must be held.
+    void Flush(Connection* connection);
+
+    ServerOptions options_;
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    // Stop writes to it, waking Serve
+    int stop_fd_ = -1;
+    // only used by the thread running Serve
+    std::unordered_map<int, std::shared_ptr<Connection>> connections_;
+    // set while connections aren't accepted, see Accept; only used by the thread running Serve
+    std::optional<std::chrono::steady_clock::time_point> accept_resumes_at_;
+
+    // connections with requests for a worker to answer
+    std::mutex ready_mutex_;
+    std::condition_variable ready_changed_;
+    std::deque<std::shared_ptr<Connection>> ready_;
+    bool is_stopping_ = false;
+    std::vector<std::thread> workers_;
+
+    std::atomic<size_t> queue_depth_ = 0;
+    std::atomic<size_t> max_queue_depth_ = 0;
+    mutable std::mutex metrics_mutex_;
+    ServerMetrics totals_;
+    // a ring of the latest latencies in nanoseconds
+    std::vector<int64_t> latencies_;
+    size_t next_latency_ = 0;
+};
+
+struct ServerResponse {
+    ResponseStatus status;
+    std::string payload;
+};
+
+// A connection to a Server, for one thread at a time.
+class ServerClient {
+public:
+    // Throws std::system_error if there is no server at socket_path.
+    explicit ServerClient(const std::string& socket_path);
+    ServerClient(const ServerClient&) = delete;
+    ServerClient& operator=(const ServerClient&) = delete;
+    ~ServerClient();
+
+    // Sends a request and waits for its response. Throws std::system_error if the connection
+    // fails.
+    ServerResponse Send(RequestKind kind, std::string_view payload);
+
+private:
+    int fd_ = -1;
+};
@@ -0,0 +1,44 @@
+#include "source_map.h"
+
+#include <algorithm>
+#include <cctype>
+
+// longer text is cut to this many characters in Describe
+const size_t kMaxDescribedText = 48;
+
+SourceMap::SourceMap(std::string source) : source_{std::move(source)} {
+    for (size_t i = 0; i < source_.size(); ++i) {
+        if (source_[i] == '\n') {
+            line_starts_.push_back(static_cast<uint32_t>(i + 1));
+        }
+    }
+}
+
+SourcePosition SourceMap::Locate(uint32_t offset) const {
+    auto next_line = std::upper_bound(line_starts_.begin(), line_starts_.end(), offset);
+    uint32_t line_start = next_line == line_starts_.begin() ? 0 : *(next_line - 1);
+    return {static_cast<uint32_t>(next_line - line_starts_.begin()) + 1, offset - line_start + 1};
+}
+
+std::string SourceMap::Describe(SourceSpan span) const {
+    std::string text;
+    bool is_space = false;
+    for (uint32_t i = span.begin; i < span.end && i < source_.size(); ++i) {
+        unsigned char c = source_[i];
+        if (std::isspace(c) || c == ';') {
+            is_space = true;
+            continue;
+        }
+        if (is_space && !text.empty()) {
+            text += ' ';
+        }
+        is_space = false;
+        if (text.size() >= kMaxDescribedText) {
+            text += "...";
+            break;
+        }
+        text += static_cast<char>(c);
+    }
+    SourcePosition position = Locate(span.begin);
+    return text + ' ' + std::to_string(position.line) + ':' + std::to_string(position.column);
+}
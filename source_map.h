@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Object;
+
+// Byte offsets of a token or an expression in its source, end excluded.
+struct SourceSpan {
+    uint32_t begin = 0;
+    uint32_t end = 0;
+
+    bool IsEmpty() const {
+        return begin == end;
+    }
+};
+
+// Both counted from 1.
+struct SourcePosition {
+    uint32_t line = 1;
+    uint32_t column = 1;
+};
+
+// Where the lists of one source were read from. It sits beside the tree rather than in it, so
+// nodes don't grow; a node is only a key, and only means something while the tree read from
+// this source is alive.
+class SourceMap {
+public:
+    explicit SourceMap(std::string source);
+
+    void Add(const Object* node, SourceSpan span) {
+        spans_[node] = span;
+    }
+    // nullptr for nodes which were not read from the source, e.g. made while evaluating
+    const SourceSpan* Find(const Object* node) const {
+        auto it = spans_.find(node);
+        return it == spans_.end() ? nullptr : &it->second;
+    }
+
+    const std::string& GetSource() const {
+        return source_;
+    }
+    SourcePosition Locate(uint32_t offset) const;
+    // The text of span on one line followed by where it starts, e.g. "(fib (- n 1)) 3:12". Long
+    // text is cut short, and semicolons, which separate frames of folded stacks, are dropped.
+    std::string Describe(SourceSpan span) const;
+
+private:
+    std::string source_;
+    // offsets at which lines after the first begin
+    std::vector<uint32_t> line_starts_;
+    std::unordered_map<const Object*, SourceSpan> spans_;
+};
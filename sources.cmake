@@ -1,7 +1,22 @@
 add_library(scheme_basic
     tokenizer.cpp
     parser.cpp
+    printer.cpp
     scheme.cpp
+    symbol_table.cpp
+    arena.cpp
+    bytecode.cpp
+    gc.cpp
+    fold.cpp
+    result_cache.cpp
+    bignum.cpp
+    vector_kernels.cpp
+    runtime_stats.cpp
+    source_map.cpp
+    profiler.cpp
+    deadline.cpp
+    server.cpp
+    ast_image.cpp
         object.cpp
         object.cpp
         object.cpp
@@ -9,3 +24,48 @@ add_library(scheme_basic
 
         # maybe more .cpp files here
 )
+
+add_executable(type_dispatch_bench bench/type_dispatch_bench.cpp)
+target_link_libraries(type_dispatch_bench scheme_basic)
+
+add_executable(tokenizer_bench bench/tokenizer_bench.cpp)
+target_link_libraries(tokenizer_bench scheme_basic)
+
+find_package(Threads REQUIRED)
+target_link_libraries(scheme_basic Threads::Threads)
+
+add_executable(batch_bench bench/batch_bench.cpp)
+target_link_libraries(batch_bench scheme_basic)
+
+add_executable(scheme_bench bench/scheme_bench.cpp)
+target_link_libraries(scheme_bench scheme_basic)
+
+add_executable(tail_call_bench bench/tail_call_bench.cpp)
+target_link_libraries(tail_call_bench scheme_basic)
+
+add_executable(result_cache_bench bench/result_cache_bench.cpp)
+target_link_libraries(result_cache_bench scheme_basic)
+
+add_executable(bignum_bench bench/bignum_bench.cpp)
+target_link_libraries(bignum_bench scheme_basic)
+
+add_executable(vector_bench bench/vector_bench.cpp)
+target_link_libraries(vector_bench scheme_basic)
+
+add_executable(list_bench bench/list_bench.cpp)
+target_link_libraries(list_bench scheme_basic)
+
+add_executable(stats_bench bench/stats_bench.cpp)
+target_link_libraries(stats_bench scheme_basic)
+
+add_executable(server_bench bench/server_bench.cpp)
+target_link_libraries(server_bench scheme_basic)
+
+add_executable(scheme_server tools/scheme_server.cpp)
+target_link_libraries(scheme_server scheme_basic)
+
+add_executable(ast_image_bench bench/ast_image_bench.cpp)
+target_link_libraries(ast_image_bench scheme_basic)
+
+add_executable(scheme_compile tools/scheme_compile.cpp)
+target_link_libraries(scheme_compile scheme_basic)
@@ -0,0 +1,78 @@
+#include <symbol_table.h>
+
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace {
+
+const char* const kBuiltinNames[BUILTIN_SYMBOL_COUNT] = {
+    "quote", "and", "or", "not", "boolean?", "number?", "pair?", "null?", "list?", "cons", "list",
+    "car", "cdr", "list-ref", "list-tail", "length", "=", "<", ">", "<=", ">=", "+", "-", "*",
+    "/", "max", "min", "abs", "vector?", "vector", "make-vector", "vector-length", "vector-ref",
+    "list->vector", "vector->list", "runtime-stats", "#t", "#f", "()", "define", "lambda", "let",
+    "if"};
+
+class SymbolTable {
+public:
+    SymbolTable() {
+        for (const char* name : kBuiltinNames) {
+            Intern(name);
+        }
+    }
+
+    SymbolId Intern(std::string_view name) {
+        {
+            std::shared_lock lock(mutex_);
+            auto it = ids_.find(name);
+            if (it != ids_.end()) {
+                return it->second;
+            }
+        }
+        std::unique_lock lock(mutex_);
+        // another thread may have added the name while no lock was held
+        auto it = ids_.find(name);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+        SymbolId id = names_.size();
+        // deque never moves its elements, so the views used as keys stay valid
+        const std::string& stored = names_.emplace_back(name);
+        ids_.emplace(stored, id);
+        return id;
+    }
+
+    const std::string& Name(SymbolId id) const {
+        std::shared_lock lock(mutex_);
+        return names_[id];
+    }
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::deque<std::string> names_;
+    std::unordered_map<std::string_view, SymbolId> ids_;
+};
+
+SymbolTable& GetSymbolTable() {
+    static SymbolTable table;
+    return table;
+}
+
+}  // namespace
+
+SymbolId Intern(std::string_view name) {
+    // names this thread has already seen are resolved without touching the shared table's lock
+    thread_local std::unordered_map<std::string_view, SymbolId> seen;
+    auto it = seen.find(name);
+    if (it != seen.end()) {
+        return it->second;
+    }
+    SymbolId id = GetSymbolTable().Intern(name);
+    seen.emplace(GetSymbolTable().Name(id), id);
+    return id;
+}
+
+const std::string& SymbolName(SymbolId id) {
+    return GetSymbolTable().Name(id);
+}
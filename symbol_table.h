@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+
+using SymbolId = uint32_t;
+
+// Symbols which are interned before anything else, so their ids are known at compile time.
+// Builtin functions go first: an id below FUNCTION_COUNT is a direct index into dispatch tables.
+enum BuiltinSymbol : SymbolId {
+    QUOTE,
+    AND,
+    OR,
+    NOT,
+    IS_BOOLEAN,
+    IS_NUMBER,
+    IS_PAIR,
+    IS_NULL,
+    IS_LIST,
+    CONS,
+    LIST,
+    CAR,
+    CDR,
+    LIST_REF,
+    LIST_TAIL,
+    LENGTH,
+    EQUAL,
+    LESS,
+    GREATER,
+    LESS_EQUAL,
+    GREATER_EQUAL,
+    PLUS,
+    MINUS,
+    MULTIPLY,
+    DIVIDE,
+    MAX,
+    MIN,
+    ABS,
+    IS_VECTOR,
+    VECTOR,
+    MAKE_VECTOR,
+    VECTOR_LENGTH,
+    VECTOR_REF,
+    LIST_TO_VECTOR,
+    VECTOR_TO_LIST,
+    RUNTIME_STATS,
+    FUNCTION_COUNT,
+    TRUE_LITERAL = FUNCTION_COUNT,
+    FALSE_LITERAL,
+    EMPTY_LIST,
+    DEFINE,
+    LAMBDA,
+    LET,
+    IF,
+    BUILTIN_SYMBOL_COUNT
+};
+
+// Both are safe to call from several threads. Names are never removed, so the reference returned
+// by SymbolName stays valid for the whole program.
+SymbolId Intern(std::string_view name);
+const std::string& SymbolName(SymbolId id);
+
+inline bool IsBuiltinFunction(SymbolId id) {
+    return id < FUNCTION_COUNT;
+}
+
+inline bool IsSpecialForm(SymbolId id) {
+    return DEFINE <= id && id <= IF;
+}
+
+// Everything which is not reserved by the language can name a variable.
+inline bool IsVariableName(SymbolId id) {
+    return id >= BUILTIN_SYMBOL_COUNT;
+}
+
+// Dispatch table indexed by builtin function id; entries which are not listed stay
+// value-initialized.
+template <class T>
+class BuiltinTable {
+public:
+    BuiltinTable(std::initializer_list<std::pair<BuiltinSymbol, T>> entries) {
+        for (const auto& [id, value] : entries) {
+            table_[id] = value;
+        }
+    }
+    const T& operator[](SymbolId id) const {
+        return table_[id];
+    }
+
+private:
+    std::array<T, FUNCTION_COUNT> table_{};
+};
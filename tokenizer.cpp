@@ -1,47 +1,84 @@
 #include <tokenizer.h>
 
 void Tokenizer::TryParse() {
-    int input = flow_->get();
+    consumed_end_ = token_end_;
+    int input = Get();
     if (!IsValid(input)) {
         do {
-            input = flow_->get();
-        } while (!IsValid(input) && flow_->peek() != EOF);
+            input = Get();
+        } while (!IsValid(input) && Peek() != EOF);
     }
+    size_t begin = position_ - (input != EOF);
     if (IsDigit(input)) {
-        int int_buffer = input - '0';
-        while (IsDigit(flow_->peek())) {
-            int_buffer = int_buffer * kNextDischarge + flow_->get() - '0';
+        int64_t int_buffer = input - '0';
+        bool is_big = false;
+        while (IsDigit(Peek())) {
+            char digit = static_cast<char>(Get());
+            int64_t next;
+            if (!is_big && (__builtin_mul_overflow(int_buffer, kNextDischarge, &next) ||
+                            __builtin_add_overflow(next, digit - '0', &next))) {
+                // the digits so far are exactly int_buffer, the rest are kept as text
+                is_big = true;
+                name_buffer_ = std::to_string(int_buffer);
+            }
+            if (is_big) {
+                name_buffer_ += digit;
+            } else {
+                int_buffer = next;
+            }
+        }
+        if (is_big) {
+            BigInteger value = *BigInteger::Parse(name_buffer_);
+            if (sgn_ == kSingularSGN) {
+                value = -value;
+            }
+            // -2^63 is read as a magnitude out of range
+            last_tokens_ = value.FitsInt64()
+                               ? ConstantToken{value.ToInt64(), nullptr}
+                               : ConstantToken{0, std::make_shared<const BigInteger>(value)};
+        } else {
+            last_tokens_ = ConstantToken{sgn_ * int_buffer, nullptr};
         }
-        last_tokens_ = ConstantToken{sgn_ * int_buffer};
         sgn_ = kDefaultSGN;
     } else if (input == '(' || input == ')') {
         last_tokens_ = (input == '(' ? BracketToken::OPEN : BracketToken::CLOSE);
+    } else if (input == '#' && Peek() == '(') {
+        Get();
+        last_tokens_ = BracketToken::VECTOR_OPEN;
     } else if (input == '\'') {
         last_tokens_ = QuoteToken();
     } else if (input == '.') {
         last_tokens_ = DotToken();
     } else if (input == '+' || input == '-') {
-        if (IsDigit(flow_->peek())) {
+        if (IsDigit(Peek())) {
             sgn_ = (input == '-' ? kSingularSGN : kDefaultSGN);
             TryParse();
+            token_begin_ = begin;
             return;
         }
-        last_tokens_ = SymbolToken{(input == '+' ? "+" : "-")};
-    } else if (kStartSymbols.find(input) != kStartSymbols.end()) {
-        char symbol = input;
-        std::string str;
-        str += symbol;
-        while (kInternalSymbols.find(flow_->peek()) != kInternalSymbols.end()) {
-            symbol = flow_->get();
-            str += symbol;
+        last_tokens_ = SymbolToken{input == '+' ? PLUS : MINUS};
+    } else if (HasClass(input, SYMBOL_START_CHAR)) {
+        if (flow_) {
+            name_buffer_.clear();
+            name_buffer_ += static_cast<char>(input);
+            while (HasClass(Peek(), SYMBOL_INTERNAL_CHAR)) {
+                name_buffer_ += static_cast<char>(Get());
+            }
+            last_tokens_ = SymbolToken{Intern(name_buffer_)};
+        } else {
+            while (HasClass(Peek(), SYMBOL_INTERNAL_CHAR)) {
+                ++position_;
+            }
+            last_tokens_ = SymbolToken{Intern(source_.substr(begin, position_ - begin))};
         }
-        last_tokens_ = SymbolToken{str};
     } else {
         is_end_ = true;
     }
+    token_begin_ = begin;
+    token_end_ = position_;
     if (!IsValid(input)) {
         do {
-            input = flow_->get();
-        } while (!IsValid(input) && flow_->peek() != EOF);
+            input = Get();
+        } while (!IsValid(input) && Peek() != EOF);
     }
-}
\ No newline at end of file
+}
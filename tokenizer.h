@@ -1,30 +1,74 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <cstdio>
 #include <istream>
+#include <memory>
 #include <optional>
-#include <unordered_set>
+#include <string_view>
 #include <variant>
 
+#include "bignum.h"
+#include "source_map.h"
+#include "symbol_table.h"
+
 const int kDefaultSGN = 1;
 const int kSingularSGN = -1;
 const int kNextDischarge = 10;
 const int kStartDigitsSegm = 48;
 const int kFinishDigitsSegm = 57;
 
-const std::unordered_set<char> kStartSymbols = {
-    'q', 'w', 'e', 'r', 't', 'y', 'u', 'i', 'o', 'p', 'a', 's', 'd', 'f', 'g',
-    'h', 'j', 'k', 'l', 'z', 'x', 'c', 'v', 'b', 'n', 'm', 'Q', 'W', 'E', 'R',
-    'T', 'Y', 'U', 'I', 'O', 'P', 'A', 'S', 'D', 'F', 'G', 'H', 'J', 'K', 'L',
-    'Z', 'X', 'C', 'V', 'B', 'N', 'M', '<', '=', '>', '*', '/', '#'};
+// Character classes of the tokenizer, one bit per class, looked up in kCharClasses.
+enum CharClass : uint8_t {
+    DIGIT_CHAR = 1 << 0,
+    SYMBOL_START_CHAR = 1 << 1,     // may begin a symbol
+    SYMBOL_INTERNAL_CHAR = 1 << 2,  // may continue a symbol
+    PUNCTUATION_CHAR = 1 << 3,      // ( ) ' . + -
+};
+
+constexpr std::array<uint8_t, 256> MakeCharClasses() {
+    std::array<uint8_t, 256> classes{};
+    for (int c = '0'; c <= '9'; ++c) {
+        classes[c] |= DIGIT_CHAR | SYMBOL_INTERNAL_CHAR;
+    }
+    for (int c = 'a'; c <= 'z'; ++c) {
+        classes[c] |= SYMBOL_START_CHAR | SYMBOL_INTERNAL_CHAR;
+    }
+    for (int c = 'A'; c <= 'Z'; ++c) {
+        classes[c] |= SYMBOL_START_CHAR | SYMBOL_INTERNAL_CHAR;
+    }
+    for (unsigned char c : std::string_view("<=>*/#")) {
+        classes[c] |= SYMBOL_START_CHAR | SYMBOL_INTERNAL_CHAR;
+    }
+    for (unsigned char c : std::string_view("?!-")) {
+        classes[c] |= SYMBOL_INTERNAL_CHAR;
+    }
+    for (unsigned char c : std::string_view("()'.+-")) {
+        classes[c] |= PUNCTUATION_CHAR;
+    }
+    return classes;
+}
+
+inline constexpr std::array<uint8_t, 256> kCharClasses = MakeCharClasses();
 
-const std::unordered_set<char> kInternalSymbols = {
-    'q', 'w', 'e', 'r', 't', 'y', 'u', 'i', 'o', 'p', 'a', 's', 'd', 'f', 'g', 'h', 'j', 'k',
-    'l', 'z', 'x', 'c', 'v', 'b', 'n', 'm', 'Q', 'W', 'E', 'R', 'T', 'Y', 'U', 'I', 'O', 'P',
-    'A', 'S', 'D', 'F', 'G', 'H', 'J', 'K', 'L', 'Z', 'X', 'C', 'V', 'B', 'N', 'M', '<', '=',
-    '>', '*', '/', '#', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '0', '?', '!', '-'};
+// `input` is a character as returned by std::istream::get, EOF belongs to no class.
+inline bool HasClass(int input, uint8_t char_class) {
+    return input != EOF && (kCharClasses[static_cast<unsigned char>(input)] & char_class);
+}
 
 struct SymbolToken {
-    std::string name;
+    SymbolId id;
+
+    SymbolToken(SymbolId symbol_id) : id{symbol_id} {
+    }
+    SymbolToken(std::string_view name) : id{Intern(name)} {
+    }
+    SymbolToken(const char* name) : id{Intern(name)} {
+    }
+    const std::string& GetName() const {
+        return SymbolName(id);
+    }
 
     bool operator==(const SymbolToken& other) const = default;
 };
@@ -37,16 +81,27 @@ struct DotToken {
     bool operator==(const DotToken&) const = default;
 };
 
-enum class BracketToken { OPEN, CLOSE };
+// VECTOR_OPEN is the "#(" which starts a numeric vector literal.
+enum class BracketToken { OPEN, CLOSE, VECTOR_OPEN };
 
+// An integer literal: in value when an int64_t holds it, otherwise in big.
 struct ConstantToken {
-    int value;
-
-    bool operator==(const ConstantToken& other) const = default;
+    int64_t value = 0;
+    std::shared_ptr<const BigInteger> big;
+
+    bool operator==(const ConstantToken& other) const {
+        if (big || other.big) {
+            return big && other.big && *big == *other.big;
+        }
+        return value == other.value;
+    }
 };
 
 using Token = std::variant<ConstantToken, BracketToken, SymbolToken, QuoteToken, DotToken>;
 
+// Reads tokens either from a stream, one character at a time, or straight from a buffer. In
+// buffer mode nothing is copied: symbol names are interned from the source bytes and GetText
+// refers to the source. The buffer must outlive the tokenizer.
 class Tokenizer {
 public:
     void TryParse();
@@ -55,6 +110,10 @@ public:
         Next();
     }
 
+    Tokenizer(std::string_view source) : flow_(nullptr), source_(source) {
+        Next();
+    }
+
     bool IsEnd() {
         return is_end_;
     }
@@ -67,17 +126,59 @@ public:
         return last_tokens_;
     }
 
+    // Source bytes of the current token, empty when reading from a stream.
+    std::string_view GetText() const {
+        if (flow_) {
+            return {};
+        }
+        return source_.substr(token_begin_, token_end_ - token_begin_);
+    }
+
+    // Where the current token is, in characters consumed from a stream or bytes of a buffer.
+    SourceSpan GetSpan() const {
+        return {static_cast<uint32_t>(token_begin_), static_cast<uint32_t>(token_end_)};
+    }
+    // The end of the token before the current one, i.e. of the last token passed with Next.
+    uint32_t GetConsumedEnd() const {
+        return static_cast<uint32_t>(consumed_end_);
+    }
+
 private:
     bool IsDigit(int input) {
-        return (kStartDigitsSegm <= input && input <= kFinishDigitsSegm);
+        return HasClass(input, DIGIT_CHAR);
     }
     bool IsValid(int input) {
-        return IsDigit(input) || (input == '(') || (input == ')') || (input == '\'') ||
-               (input == '.') || (input == '+') || (input == '-') ||
-               (kStartSymbols.find(input) != kStartSymbols.end());
+        return HasClass(input, DIGIT_CHAR | SYMBOL_START_CHAR | PUNCTUATION_CHAR);
+    }
+    int Get() {
+        if (flow_) {
+            int input = flow_->get();
+            position_ += (input != EOF);
+            return input;
+        }
+        if (position_ == source_.size()) {
+            return EOF;
+        }
+        return static_cast<unsigned char>(source_[position_++]);
+    }
+    int Peek() {
+        if (flow_) {
+            return flow_->peek();
+        }
+        if (position_ == source_.size()) {
+            return EOF;
+        }
+        return static_cast<unsigned char>(source_[position_]);
     }
     bool is_end_ = false;
     int sgn_ = kDefaultSGN;
     std::istream* flow_;
+    std::string_view source_;
+    // characters consumed so far
+    size_t position_ = 0;
+    size_t token_begin_ = 0;
+    size_t token_end_ = 0;
+    size_t consumed_end_ = 0;
+    std::string name_buffer_;
     Token last_tokens_;
 };
\ No newline at end of file
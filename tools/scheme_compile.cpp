@@ -0,0 +1,38 @@
+// Writes the top-level forms of a script as an image for Interpreter::RunAstImage, see
+// WriteAstImage.
+//
+// usage: scheme_compile SCRIPT IMAGE
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include <ast_image.h>
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "usage: scheme_compile SCRIPT IMAGE\n";
+        return 2;
+    }
+    std::ifstream script(argv[1], std::ios::binary);
+    if (!script) {
+        std::cerr << "can't open " << argv[1] << "\n";
+        return 1;
+    }
+    std::string text{std::istreambuf_iterator<char>(script), std::istreambuf_iterator<char>()};
+    std::string image;
+    try {
+        image = WriteAstImage(text);
+    } catch (const std::exception& error) {
+        std::cerr << argv[1] << ": " << error.what();
+        return 1;
+    }
+    std::ofstream output(argv[2], std::ios::binary);
+    output.write(image.data(), image.size());
+    if (!output.flush()) {
+        std::cerr << "can't write " << argv[2] << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Serves Interpreter::Run over a Unix domain socket, see Server for the protocol. Prints the
+// metrics when stopped by SIGINT or SIGTERM.
+//
+// usage: scheme_server SOCKET [--workers N] [--timeout-ms N] [--queue N]
+//                      [--connection-queue N]
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <server.h>
+
+namespace {
+
+Server* running_server = nullptr;
+
+void HandleSignal(int) {
+    running_server->Stop();
+}
+
+int Usage() {
+    std::cerr << "usage: scheme_server SOCKET [--workers N] [--timeout-ms N] [--queue N]"
+                 " [--connection-queue N]\n";
+    return 2;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc % 2 != 0) {
+        return Usage();
+    }
+    ServerOptions options;
+    options.socket_path = argv[1];
+    for (int i = 2; i < argc; i += 2) {
+        size_t value = std::strtoull(argv[i + 1], nullptr, 10);
+        if (std::strcmp(argv[i], "--workers") == 0) {
+            options.worker_count = value;
+        } else if (std::strcmp(argv[i], "--timeout-ms") == 0) {
+            options.request_timeout = std::chrono::milliseconds(value);
+        } else if (std::strcmp(argv[i], "--queue") == 0) {
+            options.queue_capacity = value;
+        } else if (std::strcmp(argv[i], "--connection-queue") == 0) {
+            options.connection_capacity = value;
+        } else {
+            return Usage();
+        }
+    }
+
+    Server server(std::move(options));
+    running_server = &server;
+    struct sigaction action{};
+    action.sa_handler = HandleSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    server.Serve();
+    std::cerr << FormatServerMetrics(server.GetMetrics());
+    return 0;
+}
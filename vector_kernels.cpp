@@ -0,0 +1,208 @@
+#include <vector_kernels.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "error.h"
+
+// GCC and Clang clone a function per target and resolve the clone when the program is loaded;
+// elsewhere the kernels are compiled once for whatever the build targets.
+#if defined(__x86_64__) && defined(__GNUC__)
+#define VECTOR_KERNEL __attribute__((target_clones("avx2", "sse4.2", "default")))
+#else
+#define VECTOR_KERNEL
+#endif
+
+namespace {
+
+// one AVX2 register, two SSE ones
+const size_t kLanes = 4;
+
+// Generic vectors: the compiler maps their operators to the instructions of each clone. The
+// arithmetic is done unsigned, where wrapping is defined and overflow is detected by hand.
+using Lanes = int64_t __attribute__((vector_size(kLanes * sizeof(int64_t))));
+using UnsignedLanes = uint64_t __attribute__((vector_size(kLanes * sizeof(int64_t))));
+
+bool IsSignSet(uint64_t value) {
+    return static_cast<int64_t>(value) < 0;
+}
+
+}  // namespace
+
+VECTOR_KERNEL bool SumElements(std::span<const int64_t> elements, int64_t* sum) {
+    const int64_t* data = elements.data();
+    size_t size = elements.size();
+    UnsignedLanes total = {};
+    UnsignedLanes overflow = {};
+    size_t i = 0;
+    for (; i + kLanes <= size; i += kLanes) {
+        UnsignedLanes next;
+        std::memcpy(&next, data + i, sizeof(next));
+        UnsignedLanes result = total + next;
+        // a signed sum overflows when both operands have a sign the result doesn't
+        overflow |= (total ^ result) & (next ^ result);
+        total = result;
+    }
+    int64_t result = 0;
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+        if (IsSignSet(overflow[lane]) ||
+            __builtin_add_overflow(result, static_cast<int64_t>(total[lane]), &result)) {
+            return false;
+        }
+    }
+    for (; i < size; ++i) {
+        if (__builtin_add_overflow(result, data[i], &result)) {
+            return false;
+        }
+    }
+    *sum = result;
+    return true;
+}
+
+VECTOR_KERNEL int64_t ExtremeElement(std::span<const int64_t> elements, bool is_max) {
+    const int64_t* data = elements.data();
+    size_t size = elements.size();
+    int64_t result = data[0];
+    size_t i = 0;
+    if (size >= kLanes) {
+        Lanes extreme;
+        std::memcpy(&extreme, data, sizeof(extreme));
+        // one loop per direction, or the comparison doesn't get vectorized
+        if (is_max) {
+            for (i = kLanes; i + kLanes <= size; i += kLanes) {
+                Lanes next;
+                std::memcpy(&next, data + i, sizeof(next));
+                extreme = next > extreme ? next : extreme;
+            }
+        } else {
+            for (i = kLanes; i + kLanes <= size; i += kLanes) {
+                Lanes next;
+                std::memcpy(&next, data + i, sizeof(next));
+                extreme = next < extreme ? next : extreme;
+            }
+        }
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            result = is_max ? std::max(result, extreme[lane]) : std::min(result, extreme[lane]);
+        }
+    }
+    for (; i < size; ++i) {
+        result = is_max ? std::max(result, data[i]) : std::min(result, data[i]);
+    }
+    return result;
+}
+
+VECTOR_KERNEL bool IsChainOrdered(SymbolId comparison, std::span<const int64_t> elements) {
+    // which orders of an element and the next one are accepted, as all-ones or zero masks, so
+    // the loop is the same for every comparison
+    int64_t accepts_less =
+        (comparison == GREATER || comparison == GREATER_EQUAL) ? int64_t(-1) : int64_t(0);
+    int64_t accepts_equal =
+        (comparison == EQUAL || comparison == LESS_EQUAL || comparison == GREATER_EQUAL)
+            ? int64_t(-1)
+            : int64_t(0);
+    int64_t accepts_greater =
+        (comparison == LESS || comparison == LESS_EQUAL) ? int64_t(-1) : int64_t(0);
+    const int64_t* data = elements.data();
+    size_t size = elements.size();
+    Lanes failed = {};
+    size_t i = 0;
+    // each element against the next one: two loads of overlapping windows
+    for (; i + kLanes < size; i += kLanes) {
+        Lanes current;
+        Lanes next;
+        std::memcpy(&current, data + i, sizeof(current));
+        std::memcpy(&next, data + i + 1, sizeof(next));
+        Lanes is_greater = next > current;
+        Lanes is_equal = next == current;
+        Lanes is_less = ~(is_greater | is_equal);
+        failed |= ~((is_less & accepts_less) | (is_equal & accepts_equal) |
+                    (is_greater & accepts_greater));
+    }
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+        if (failed[lane]) {
+            return false;
+        }
+    }
+    for (; i + 1 < size; ++i) {
+        int64_t order = data[i + 1] < data[i] ? accepts_less
+                        : data[i + 1] == data[i] ? accepts_equal
+                                                 : accepts_greater;
+        if (!order) {
+            return false;
+        }
+    }
+    return true;
+}
+
+VECTOR_KERNEL bool ApplyElementwise(SymbolId function, std::span<int64_t> lhs,
+                                    std::span<const int64_t> rhs) {
+    int64_t* data = lhs.data();
+    const int64_t* operands = rhs.data();
+    size_t size = lhs.size();
+    size_t i = 0;
+    if (function == PLUS || function == MINUS) {
+        bool is_plus = function == PLUS;
+        UnsignedLanes overflow = {};
+        for (; i + kLanes <= size; i += kLanes) {
+            UnsignedLanes left;
+            UnsignedLanes right;
+            std::memcpy(&left, data + i, sizeof(left));
+            std::memcpy(&right, operands + i, sizeof(right));
+            UnsignedLanes result = is_plus ? left + right : left - right;
+            // a difference overflows when the operands differ in sign and the result takes the
+            // sign of the subtrahend
+            overflow |= is_plus ? (left ^ result) & (right ^ result)
+                                : (left ^ right) & (left ^ result);
+            std::memcpy(data + i, &result, sizeof(result));
+        }
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            if (IsSignSet(overflow[lane])) {
+                return false;
+            }
+        }
+        for (; i < size; ++i) {
+            if (is_plus ? __builtin_add_overflow(data[i], operands[i], &data[i])
+                        : __builtin_sub_overflow(data[i], operands[i], &data[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (function == MAX || function == MIN) {
+        bool is_max = function == MAX;
+        for (; i + kLanes <= size; i += kLanes) {
+            Lanes left;
+            Lanes right;
+            std::memcpy(&left, data + i, sizeof(left));
+            std::memcpy(&right, operands + i, sizeof(right));
+            Lanes is_right = is_max ? right > left : right < left;
+            Lanes result = is_right ? right : left;
+            std::memcpy(data + i, &result, sizeof(result));
+        }
+        for (; i < size; ++i) {
+            data[i] = is_max ? std::max(data[i], operands[i]) : std::min(data[i], operands[i]);
+        }
+        return true;
+    }
+    // neither has a 64-bit vector instruction short of AVX-512
+    for (; i < size; ++i) {
+        if (function == MULTIPLY) {
+            if (__builtin_mul_overflow(data[i], operands[i], &data[i])) {
+                return false;
+            }
+            continue;
+        }
+        if (operands[i] == 0) {
+            throw RuntimeError("division by zero\n");
+        }
+        // INT64_MIN / -1 is the one quotient out of range
+        if (operands[i] == -1) {
+            if (__builtin_sub_overflow(0, data[i], &data[i])) {
+                return false;
+            }
+            continue;
+        }
+        data[i] /= operands[i];
+    }
+    return true;
+}
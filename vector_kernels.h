@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "symbol_table.h"
+
+// Loops over the elements of a numeric vector. Each is compiled for AVX2, for SSE4.2 and for the
+// baseline instruction set, and the loader picks the best one the CPU supports.
+
+// The sum of elements; false if it doesn't fit in an int64_t. Partial sums are kept per lane, so
+// it may also give up on a sum which fits after all.
+bool SumElements(std::span<const int64_t> elements, int64_t* sum);
+
+// The largest element if is_max, the smallest otherwise; elements must not be empty.
+int64_t ExtremeElement(std::span<const int64_t> elements, bool is_max);
+
+// Whether comparison (EQUAL, LESS, GREATER, LESS_EQUAL or GREATER_EQUAL) holds between every
+// element and the next one, the way (< e0 e1 e2 ...) does.
+bool IsChainOrdered(SymbolId comparison, std::span<const int64_t> elements);
+
+// lhs[i] = lhs[i] op rhs[i] for PLUS, MINUS, MULTIPLY, DIVIDE, MAX or MIN; false, with lhs left
+// unspecified, if an element doesn't fit in an int64_t. Division by zero throws RuntimeError.
+bool ApplyElementwise(SymbolId function, std::span<int64_t> lhs, std::span<const int64_t> rhs);